@@ -0,0 +1,155 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "settings.h"
+#include "topology.h"
+
+enum class HugePages{
+    NONE = 0,
+    TRANSPARENT = 1,    // madvise(MADV_HUGEPAGE), kernel backs the region by huge pages when it can
+    EXPLICIT = 2        // MAP_HUGETLB, needs pages reserved in /proc/sys/vm/nr_hugepages
+};
+
+/* Maps region of given size, huge pages are used if requested. If explicit huge pages are not available,
+   falls back to transparent ones. Throws std::bad_alloc if memory cannot be mapped at all. */
+void* map_region(size_t bytes, HugePages huge_pages, bool prefault, int numa_node = NUMA_DEFAULT);
+void unmap_region(void* ptr, size_t bytes) noexcept;
+
+/* Slab allocator for records of one type. Records are placed one after another in large mmap-ed chunks and
+   addressed by 32-bit index instead of pointer, index 0 is never allocated so it can be used as null.
+   Records are never moved or freed individually, whole arena is released at once. Not thread safe.
+   In NUMA partition mode each NUMA node fills its own chunk, placed in memory of that node. */
+template <typename T>
+class Arena{
+public:
+    static constexpr uint32_t NONE = 0;
+
+    Arena() noexcept
+        : m_size(0)
+        , m_n_chunks(0)
+        , m_huge_pages(HugePages::NONE)
+        , m_prefault(false)
+        , m_numa_mode(NumaMode::NONE)
+        , m_n_numa_nodes(1) {
+        m_chunks.fill(nullptr);
+        m_next.fill(0);
+        m_end.fill(0);
+    }
+    ~Arena() {
+        for (size_t i = 0; i < m_n_chunks; i++) {
+            unmap_region(m_chunks[i], chunk_bytes());
+        }
+    }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /* Has to be called before the first allocation to have an effect */
+    inline void set_page_mode(HugePages huge_pages, bool prefault) noexcept {
+        m_huge_pages = huge_pages;
+        m_prefault = prefault;
+    }
+
+    inline void set_numa_mode(NumaMode mode, int n_numa_nodes) noexcept {
+        m_numa_mode = mode;
+        m_n_numa_nodes = mode == NumaMode::PARTITION ? std::clamp(n_numa_nodes, 1, MAX_NUMA_NODES) : 1;
+    }
+
+    /* Maps chunks for n records upfront, so they are not mapped (and pre-faulted) while training */
+    void reserve(size_t n) {
+        size_t n_chunks = (n + 1 + (size_t(1) << ARENA_CHUNK_BITS) - 1) >> ARENA_CHUNK_BITS;
+        /* map_chunk() advances m_n_chunks */
+        while (m_n_chunks < n_chunks && m_n_chunks < m_chunks.size()) {
+            int slot = static_cast<int>(m_n_chunks % m_n_numa_nodes);
+            m_spare[slot].push_back(map_chunk(slot));
+        }
+    }
+
+    /* numa_node is the node of calling thread, it matters only in partition mode */
+    uint32_t allocate(int numa_node = 0) {
+        int slot = m_numa_mode == NumaMode::PARTITION ? numa_node % m_n_numa_nodes : 0;
+        if (m_next[slot] == m_end[slot]) {
+            size_t chunk;
+            if (!m_spare[slot].empty()) {
+                chunk = m_spare[slot].back();
+                m_spare[slot].pop_back();
+            } else if (m_n_chunks < m_chunks.size()) {
+                chunk = map_chunk(slot);
+            } else {
+                throw std::length_error("Arena is full");
+            }
+            /* Index 0 is null */
+            m_next[slot] = chunk == 0 ? 1 : chunk << ARENA_CHUNK_BITS;
+            m_end[slot] = (chunk + 1) << ARENA_CHUNK_BITS;
+        }
+        uint32_t idx = static_cast<uint32_t>(m_next[slot]++);
+        m_size++;
+        new (&at(idx)) T();
+        return idx;
+    }
+
+    inline T& at(uint32_t idx) const noexcept {
+        return m_chunks[idx >> ARENA_CHUNK_BITS][idx & ((1u << ARENA_CHUNK_BITS) - 1)];
+    }
+
+    /* Number of allocated records */
+    inline size_t size() const noexcept {return m_size;};
+    inline size_t bytes_mapped() const noexcept {return m_n_chunks * chunk_bytes();};
+
+private:
+    size_t map_chunk(int slot) {
+        int numa_node = NUMA_DEFAULT;
+        if (m_numa_mode == NumaMode::INTERLEAVE) {
+            numa_node = NUMA_INTERLEAVE;
+        } else if (m_numa_mode == NumaMode::PARTITION) {
+            numa_node = slot;
+        }
+        m_chunks[m_n_chunks] = static_cast<T*>(map_region(chunk_bytes(), m_huge_pages, m_prefault, numa_node));
+        return m_n_chunks++;
+    }
+
+    static constexpr size_t chunk_bytes() noexcept {
+        /* Rounded up to 2MB so explicit huge pages can back the whole chunk */
+        size_t bytes = sizeof(T) << ARENA_CHUNK_BITS;
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    std::array<T*, (size_t(1) << (32 - ARENA_CHUNK_BITS))> m_chunks;
+    size_t m_size;
+    size_t m_n_chunks;
+    HugePages m_huge_pages;
+    bool m_prefault;
+    NumaMode m_numa_mode;
+    int m_n_numa_nodes;
+
+    /* Next free and end index of chunk being filled by each NUMA node */
+    std::array<size_t, MAX_NUMA_NODES> m_next;
+    std::array<size_t, MAX_NUMA_NODES> m_end;
+    /* Chunks mapped by reserve() and not filled yet */
+    std::array<std::vector<size_t>, MAX_NUMA_NODES> m_spare;
+};
+
+#endif
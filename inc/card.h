@@ -32,6 +32,7 @@ public:
 
     inline char get_value_str() const noexcept {return m_str;};
     inline char get_value() const noexcept {return m_int + 2;};
+    inline uint8_t get_code() const noexcept {return m_code;};
 
     inline uint32_t get_suit_hash() const noexcept {return m_suit_hash;};
     inline uint32_t get_value_hash() const noexcept {return m_value_hash;};
@@ -0,0 +1,109 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _CORO_H
+#define _CORO_H
+
+#include <coroutine>
+#include <deque>
+#include <utility>
+
+/* Coroutine returning value of type T. Task is started lazily, either by co_await from another task, which
+   is resumed once the task finishes, or as root task by start(). */
+template <typename T>
+class Task{
+public:
+    struct promise_type;
+    typedef std::coroutine_handle<promise_type> handle_type;
+
+    struct promise_type{
+        T value;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() noexcept {return Task(handle_type::from_promise(*this));}
+        std::suspend_always initial_suspend() noexcept {return {};}
+        void return_value(T v) noexcept {value = v;}
+        void unhandled_exception() {throw;}
+
+        /* Continue with awaiting task directly, without going through scheduler */
+        struct FinalAwaiter{
+            bool await_ready() noexcept {return false;}
+            std::coroutine_handle<> await_suspend(handle_type h) noexcept {
+                std::coroutine_handle<> c = h.promise().continuation;
+                return c ? c : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept {return {};}
+    };
+
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (m_handle) m_handle.destroy();
+        m_handle = std::exchange(other.m_handle, nullptr);
+        return *this;
+    }
+    ~Task() {if (m_handle) m_handle.destroy();}
+
+    bool await_ready() const noexcept {return false;}
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        m_handle.promise().continuation = caller;
+        return m_handle;
+    }
+    T await_resume() const noexcept {return m_handle.promise().value;}
+
+    /* Root task - runs until it finishes or yields */
+    inline void start() {m_handle.resume();}
+    inline bool done() const noexcept {return m_handle.done();}
+    inline T result() const noexcept {return m_handle.promise().value;}
+
+private:
+    explicit Task(handle_type h) noexcept : m_handle(h) {}
+    handle_type m_handle;
+};
+
+/* Round-robin scheduler of tasks running on one thread. Task yields by co_await Scheduler::yield() after it
+   issued prefetch of data it needs next, so other tasks run while the data is being loaded. Yield does not
+   suspend if there is no scheduler running on the thread. */
+class Scheduler{
+public:
+    struct Yield{
+        bool await_ready() const noexcept {return t_current == nullptr;}
+        void await_suspend(std::coroutine_handle<> h) {t_current->m_ready.push_back(h);}
+        void await_resume() const noexcept {}
+    };
+    static Yield yield() noexcept {return {};}
+
+    Scheduler() noexcept {t_current = this;}
+    ~Scheduler() {t_current = nullptr;}
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /* Resumes the oldest suspended task, returns false if there is none */
+    bool step() {
+        if (m_ready.empty()) return false;
+        std::coroutine_handle<> h = m_ready.front();
+        m_ready.pop_front();
+        h.resume();
+        return true;
+    }
+
+private:
+    std::deque<std::coroutine_handle<>> m_ready;
+    static inline thread_local Scheduler* t_current = nullptr;
+};
+
+#endif
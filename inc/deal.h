@@ -0,0 +1,41 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _DEAL_H
+#define _DEAL_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "settings.h"
+
+/* Betting rounds actually played before reveal */
+#define N_ROUNDS        3
+/* Hole cards of all players followed by flop, turn and river */
+#define N_DEAL_CARDS    (2 * N_PLAYERS + 5)
+
+/* Cards of one game with everything that can be evaluated before the game is played - abstraction of
+   players' cards and strength of their hands in each betting round. Game started from a deal does not have
+   to evaluate hands on its own. */
+struct Deal{
+    std::array<uint8_t, N_DEAL_CARDS> cards;
+    std::array<std::array<std::string, N_ROUNDS>, N_PLAYERS> rank_str;
+    /* Rank values, lower value is better hand */
+    std::array<std::array<uint16_t, N_ROUNDS>, N_PLAYERS> rank;
+};
+
+#endif
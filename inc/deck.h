@@ -21,6 +21,7 @@
 #include <array>
 
 #include "card.h"
+#include "deal.h"
 
 class Deck
 {
@@ -29,6 +30,10 @@ public:
     inline Card* draw() noexcept { return &m_cards[m_pointer_to_deck++]; };  
     inline Card* draw(int idx) noexcept { return &m_cards[idx]; };
     void shuffle() noexcept;
+    /* Puts cards of the deal on top of the deck in the order they are drawn */
+    void arrange(const std::array<uint8_t, N_DEAL_CARDS>& codes) noexcept;
+    /* Moves card to given position of shuffled deck */
+    void place(int position, uint8_t code) noexcept;
 private:
     int m_pointer_to_deck;
     std::array<Card, 52> m_cards;
@@ -0,0 +1,47 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _DISCOUNT_H
+#define _DISCOUNT_H
+
+#include <cstdint>
+#include <vector>
+
+/* Largest number of DCFR discount periods, discounting stops after the last one */
+#define MAX_DISCOUNT_PERIODS    (1 << 20)
+
+/* Discount factors of DCFR accumulated over any range of periods. Each node is discounted lazily when it is
+   visited, by product of factors of all periods since its last visit. Products are kept as prefix sums of
+   logarithms, so product over a range is one subtraction and exp(). */
+class DiscountTable{
+public:
+    struct Factors{
+        float positive;
+        float negative;
+        float strategy;
+    };
+
+    void init(double alpha, double beta, double gamma);
+    /* Product of factors of periods from + 1 ... to */
+    Factors between(uint32_t from, uint32_t to) const noexcept;
+
+private:
+    std::vector<double> m_positive;
+    std::vector<double> m_negative;
+    std::vector<double> m_strategy;
+};
+
+#endif
@@ -0,0 +1,33 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _EXPLOITABILITY_H
+#define _EXPLOITABILITY_H
+
+#include <functional>
+#include <string>
+
+#include "node.h"
+
+/* Copies node stored under key, returns false if there is no such node */
+typedef std::function<bool(const std::string& key, Node& node)> NodeLookup;
+
+/* Exploitability of average strategy in Leduc poker - mean value of best responses of both players against
+   average strategy of the other one, in chips per game. Game is small enough to enumerate all deals.
+   Nodes that were never visited play uniformly over valid actions. */
+float leduc_exploitability(const NodeLookup& lookup);
+
+#endif
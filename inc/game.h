@@ -24,6 +24,7 @@
 #include "player.h"
 #include "deck.h"
 #include "action.h"
+#include "deal.h"
 
 enum class Round{
     PREFLOP = 0,
@@ -38,6 +39,14 @@ public:
     Holdem(uint8_t n_players, uint16_t big_bling, uint16_t small_blind, uint8_t max_reraises);
     Holdem(Holdem& h);
     void start_game();
+    /* Starts game with cards and hand ranks prepared by dealer, deal has to outlive the game and its copies */
+    void start_game(const Deal& deal);
+    /* Game with given cards - hole cards of players in order, then flop, turn and river */
+    void start_game(const std::array<uint8_t, N_DEAL_CARDS>& cards);
+    /* Random game where player holds given cards */
+    void start_game(int8_t player, const std::array<uint8_t, 2>& hole);
+    /* Shuffles and evaluates hands of all players in every round, the game itself is not playable afterwards */
+    void prepare_deal(Deal& deal);
     bool is_running();
     int get_reward(int8_t hero);
     int8_t next_player();
@@ -46,7 +55,9 @@ public:
     bool can_raise(uint8_t player_idx, const Action& a) const noexcept;
     bool is_player_in_game(uint8_t player_idx) const noexcept {return m_players[player_idx].get_state() != PlayerState::OUT;};
     int get_player_pot_contribution(uint8_t player_idx) const noexcept {return m_players[player_idx].get_pot_contribution();};
-    // inline std::string get_history() const noexcept {return m_history;};
+    inline const std::string& get_history() const noexcept {return m_history;};
+    /* Index of preflop hand class in 0..168, same for all suit combinations */
+    inline int get_preflop_class(int player) const noexcept {return m_players[player].get_preflop_class();};
     inline std::string get_player_cards_str(int player) const noexcept {return m_players[player].get_rank_str();};
     inline const std::array<Card*, 2>& get_player_cards(int player) const noexcept {return m_players[player].get_cards();};
     inline int8_t get_current_player() const noexcept {return m_current_player;};
@@ -64,6 +75,11 @@ public:
     inline std::array<Action, N_ACTIONS> get_actions() const noexcept {return m_actions;};
 
     std::string create_key(uint8_t player);
+    /* Key of player's node if the player held cards of given abstraction */
+    std::string create_key(uint8_t player, const std::string& cards_str);
+    /* Card abstraction of hole cards in every round on the board of this game and their rank at showdown */
+    void evaluate_hole(const std::array<Card*, 2>& hole, std::array<std::string, N_ROUNDS>& rank_str,
+                       uint16_t& rank) const;
 private:
     bool check_premature_end();
     uint8_t find_max_pot_contribution();
@@ -73,6 +89,7 @@ private:
     void next_round();
     std::string round_to_str() const noexcept;
     int count_remaining_players() noexcept;
+    void deal_cards();
 
     int8_t m_current_player;
     Round m_round;
@@ -94,6 +111,9 @@ private:
     Card* m_river;
 
     std::array<Action, N_ACTIONS> m_actions;
+
+    /* Precomputed ranks, nullptr if the game evaluates hands itself */
+    const Deal* m_deal;
 };
 
 #endif
\ No newline at end of file
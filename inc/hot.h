@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _HOT_H
+#define _HOT_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "game.h"
+#include "node.h"
+#include "settings.h"
+
+#define N_PREFLOP_CLASSES   169
+
+/* Preflop node with its own lock, one per cache line(s) so threads working on different nodes do not contend */
+struct alignas(64) HotEntry{
+    std::atomic_flag locked = ATOMIC_FLAG_INIT;
+    /* Set once the node was visited for the first time */
+    bool used = false;
+    uint8_t length = 0;
+    std::array<char, KEY_LENGTH> key;
+    Node node;
+
+    inline void lock() noexcept {
+        for (int spins = 0; locked.test_and_set(std::memory_order_acquire); spins++) {
+            while (locked.test(std::memory_order_relaxed)) {
+                if (++spins > 64) std::this_thread::yield();
+            }
+        }
+    }
+    inline void unlock() noexcept {locked.clear(std::memory_order_release);}
+};
+
+/* Preflop nodes are visited by every traversal, so they would be the most contended entries of the game tree.
+   They live in a small dense array instead, indexed by preflop hand class and betting history. Histories are
+   enumerated upfront by walking the preflop betting tree. */
+class HotTier{
+public:
+    HotTier() noexcept : m_n_histories(0) {}
+
+    void init();
+    inline bool enabled() const noexcept {return m_n_histories > 0;};
+
+    /* Returns nullptr if the node of player to act is not in the hot tier */
+    HotEntry* find(const Holdem& game, uint8_t player) noexcept;
+
+    template <typename F> void for_each(F f) const {
+        for (size_t i = 0; i < m_n_histories * N_PREFLOP_CLASSES; i++) {
+            HotEntry& e = m_entries[i];
+            if (e.used) f(std::string(e.key.data(), e.length), e.node);
+        }
+    }
+
+    inline size_t size() const noexcept {return m_n_histories * N_PREFLOP_CLASSES;};
+
+    /* Calls f(key, entry) for every entry, also for the ones not used yet */
+    template <typename F> void for_each_entry(F f) {
+        for (size_t i = 0; i < size(); i++) f(entry_key(i), m_entries[i]);
+    }
+
+    /* Holds all entries, so none of them is being updated in between */
+    void lock_all() noexcept {
+        for (size_t i = 0; i < size(); i++) m_entries[i].lock();
+    }
+    void unlock_all() noexcept {
+        for (size_t i = 0; i < size(); i++) m_entries[i].unlock();
+    }
+
+private:
+    static uint32_t encode(const std::string& history) noexcept;
+    void collect_histories(Holdem& game);
+    /* Key of node of given entry, as created by Holdem::create_key() */
+    std::string entry_key(size_t idx) const;
+
+    size_t m_n_histories;
+    /* Sorted encoded histories, position is the index of history */
+    std::vector<uint32_t> m_histories;
+    /* Encoded history and the part of key following the cards, in the same order */
+    std::vector<std::pair<uint32_t, std::string>> m_suffixes;
+    std::unique_ptr<HotEntry[]> m_entries;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _IMPORTANCE_H
+#define _IMPORTANCE_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/* Importance weight of the deal of one traversal and sum of absolute regret updates the traversal made */
+struct ChanceSample{
+    float weight = 1;
+    float regret_change = 0;
+};
+
+/* Regret-guided importance sampling of hero's private cards. Cards are grouped into strata (preflop classes in
+   Holdem, ranks in Leduc), stratum is sampled with probability mixing its natural probability with one
+   proportional to recent regret change of traversals dealt from it. Utilities are multiplied by natural over
+   sampling probability, so updates stay unbiased. Not thread safe, each training thread has its own. */
+class ChanceImportance{
+public:
+    ChanceImportance(std::vector<float> probabilities, float mix);
+
+    /* Returns sampled stratum and sets importance weight of the deal */
+    int sample(float& weight);
+    /* Regret change caused by traversal dealt from stratum, unweighted */
+    void update(int stratum, float regret_change) noexcept;
+
+    inline size_t size() const noexcept {return m_probabilities.size();};
+
+private:
+    void rebuild();
+
+    std::vector<float> m_probabilities;
+    std::vector<float> m_scores;
+    std::vector<float> m_sampling;
+    std::discrete_distribution<int> m_distribution;
+    float m_mix;
+    int m_updates;
+    std::mt19937 m_rng;
+};
+
+/* Hole cards of hero in Holdem - stratum is preflop class */
+class HoldemImportance{
+public:
+    explicit HoldemImportance(float mix);
+    /* Returns hole cards and sets their stratum and weight */
+    std::array<uint8_t, 2> sample(int& stratum, float& weight);
+    inline void update(int stratum, float regret_change) noexcept {m_importance.update(stratum, regret_change);};
+
+private:
+    /* Range of hole_combos() of each class */
+    std::vector<std::array<int, 2>> m_classes;
+    ChanceImportance m_importance;
+    std::mt19937 m_rng;
+};
+
+/* Card of hero in Leduc - stratum is rank, deal is given as indices to unshuffled deck like Leduc::start_game */
+class LeducImportance{
+public:
+    explicit LeducImportance(float mix);
+    std::array<int, 3> sample(int hero, int& stratum, float& weight);
+    inline void update(int stratum, float regret_change) noexcept {m_importance.update(stratum, regret_change);};
+
+private:
+    ChanceImportance m_importance;
+    std::mt19937 m_rng;
+};
+
+#endif
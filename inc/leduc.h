@@ -14,8 +14,8 @@
  *  limitations under the License.
  */
 
-#ifndef _HOLDEM_H
-#define _HOLDEM_H
+#ifndef _LEDUC_H
+#define _LEDUC_H
 
 #include <string>
 #include <array>
@@ -25,7 +25,7 @@
 #include "deck.h"
 #include "action.h"
 
-enum class Round{
+enum class LeducRound{
     PREFLOP = 0,
     FLOP = 1,
     REVEAL = 2
@@ -36,6 +36,9 @@ public:
     Leduc(uint16_t big_bling, uint16_t small_blind, uint8_t max_reraises);
     Leduc(Leduc& h);
     void start_game();
+    /* Start new game with given cards instead of shuffled deck. Indices to unshuffled deck of player 0, player 1
+       and flop card. */
+    void start_game(const std::array<int, 3>& deal);
     bool is_running();
     int get_reward(int8_t hero);
     int8_t next_player();
@@ -48,17 +51,19 @@ public:
     inline int8_t get_current_player() const noexcept {return m_current_player;};
     int8_t find_winner();
     void update_ranks();
-    inline Round get_round() const noexcept {return m_round;};
+    inline LeducRound get_round() const noexcept {return m_round;};
     inline const Card* get_flop() const noexcept {return m_flop;};
 
     std::array<uint8_t, N_ACTIONS> get_valid_actions_mask(int player);
     std::vector<Action> get_valid_actions(int player);
+    Action sample_action(const std::array<float, N_ACTIONS>& strategy, const std::array<uint8_t, N_ACTIONS>& valid, uint8_t player);
     Action sample_action(std::array<float, N_ACTIONS> strategy, uint8_t player);
     inline std::array<Action, N_ACTIONS> get_actions() const noexcept {return m_actions;};
 
     std::string create_key(uint8_t player);
 private:
     void shuffle_cards();
+    void deal();
     inline Card* draw_card() noexcept { return &m_deck[m_pointer_to_deck++]; };  
     bool check_premature_end();
     uint8_t find_max_pot_contribution();
@@ -70,7 +75,7 @@ private:
     int count_remaining_players() noexcept;
 
     int8_t m_current_player;
-    Round m_round;
+    LeducRound m_round;
     int8_t m_winner;
     std::string m_history;
     uint8_t m_max_reraises;
@@ -17,10 +17,34 @@
 #ifndef _NODE_H
 #define _NODE_H
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include "settings.h"
 #include <string>
+#include <cmath>
 #include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/* Type of regrets and strategy sums */
+#if PURE_CFR
+typedef PURE_CFR_COUNTER Counter;
+#else
+typedef float Counter;
+#endif
+
+/* Counter increased by value, integer counters are rounded and saturate instead of overflowing */
+inline Counter add_counter(Counter c, float f) noexcept {
+    if constexpr (std::is_integral_v<Counter>) {
+        constexpr float limit = 1e15f;
+        long long sum = static_cast<long long>(c) + std::llround(std::clamp(f, -limit, limit));
+        return static_cast<Counter>(std::clamp<long long>(sum, std::numeric_limits<Counter>::min(),
+                                                          std::numeric_limits<Counter>::max()));
+    } else {
+        return c + f;
+    }
+}
 
 class Node{
 public:
@@ -29,15 +53,21 @@ public:
     // inline const std::array<float, N_ACTIONS>& get_strategy() const noexcept{return m_strategy;}
     std::array<float, N_ACTIONS> get_strategy() const noexcept;
 
-    void update_avg_strategy(const std::array<float, N_ACTIONS>& strategy) noexcept;
+    /* Weight is 1 for uniform average, iteration number for linear one */
+    void update_avg_strategy(const std::array<float, N_ACTIONS>& strategy, float weight = 1) noexcept;
 
     std::array<float, N_ACTIONS> get_average_strategy() const noexcept;
+    inline std::array<float, N_ACTIONS> get_strategy_sum() const noexcept {
+        std::array<float, N_ACTIONS> sums;
+        std::copy(m_strategy_sum.begin(), m_strategy_sum.end(), sums.begin());
+        return sums;
+    }
 
     inline operator std::string() const noexcept{
         std::string s;
         for (int i = 0; i < N_ACTIONS; i++){
             char buffer[10];  // maximum expected length of the float
-            std::snprintf(buffer, 10, "%.2e", m_regret_sum[i]);
+            std::snprintf(buffer, 10, "%.2e", static_cast<float>(m_regret_sum[i]));
             s.append(std::string(buffer) + "  |");
         }
         s.append(" |");
@@ -53,20 +83,102 @@ public:
     }
 
     inline void inc_visits() noexcept {m_visits++;}
-    inline int get_visits() noexcept {return m_visits;}
+    inline int get_visits() const noexcept {return m_visits;}
     inline void inc_visits2() noexcept {m_visits_2++;}
-    inline int get_visits2() noexcept {return m_visits_2;}
+    inline int get_visits2() const noexcept {return m_visits_2;}
 
-    inline void update_regret_sum(int idx, float f) noexcept {m_regret_sum[idx] += f * m_valid_action_mask[idx];};
-    inline std::array<float, N_ACTIONS>  get_regrets() const noexcept {return m_regret_sum;};
+    inline void update_regret_sum(int idx, float f) noexcept {
+        m_regret_sum[idx] = add_counter(m_regret_sum[idx], f * m_valid_action_mask[idx]);
+    };
+#if PURE_CFR
+    /* Pure action by regret matching, computed on integer counters only. random is uniform 64-bit number. */
+    int sample_pure(uint64_t random) const noexcept;
+#endif
+    /* Regret matching+ keeps regrets non-negative */
+    void floor_regrets() noexcept;
+    /* Discounted CFR - positive and negative regrets and strategy sum are scaled by separate factors */
+    void discount(float positive, float negative, float strategy) noexcept;
+    /* Moves node to given discount period, returns period it was discounted to so far. Only the caller that
+       moved the node discounts it, even if several threads visit the node at once. */
+    uint32_t claim_discount(uint32_t period) noexcept;
+
+    /* Relaxed (hogwild) updates applied directly on node shared by all threads. Each value is updated
+       atomically, node as a whole is not - readers may see some values before and some after an update. */
+    Node load_relaxed() const noexcept;
+    inline void update_regret_sum_atomic(int idx, float f) noexcept {
+        if (m_valid_action_mask[idx] == 0) return;
+        add_atomic(m_regret_sum[idx], f);
+    };
+    /* Atomic update with regret matching+ flooring */
+    void update_regret_sum_plus_atomic(int idx, float f) noexcept;
+    void update_avg_strategy_atomic(const std::array<float, N_ACTIONS>& strategy, float weight = 1) noexcept;
+    inline void inc_visits_atomic() noexcept {std::atomic_ref<int>(m_visits).fetch_add(1, std::memory_order_relaxed);}
+    inline void inc_visits2_atomic() noexcept {std::atomic_ref<int>(m_visits_2).fetch_add(1, std::memory_order_relaxed);}
+    inline std::array<float, N_ACTIONS>  get_regrets() const noexcept {
+        std::array<float, N_ACTIONS> regrets;
+        std::copy(m_regret_sum.begin(), m_regret_sum.end(), regrets.begin());
+        return regrets;
+    };
+
+    /* Baseline of action is exponentially decaying average of its sampled values for the player to act, used as
+       control variate */
+#if VR_BASELINES
+    inline float get_baseline(int idx) const noexcept {return m_baseline[idx];}
+    inline void update_baseline(int idx, float value, float decay) noexcept {
+        m_baseline[idx] += decay * (value - m_baseline[idx]);
+    }
+    void update_baseline_atomic(int idx, float value, float decay) noexcept;
+#else
+    inline float get_baseline(int) const noexcept {return 0;}
+    inline void update_baseline(int, float, float) noexcept {}
+    inline void update_baseline_atomic(int, float, float) noexcept {}
+#endif
     inline void set_mask(const std::array<uint8_t, N_ACTIONS>& mask) noexcept {m_valid_action_mask = mask;};
+
+    /* Freezing of converged nodes. Node is frozen if given strategy stayed within tolerance of the strategy at the
+       start of a window of visits. Frozen node is not updated until given iteration, then it is tracked again.
+       Values are accessed atomically, so the node may be shared by threads in relaxed mode. */
+    inline bool is_frozen(uint32_t iteration) const noexcept {
+        std::atomic_ref<uint32_t> frozen_until(const_cast<uint32_t&>(m_frozen_until));
+        return iteration < frozen_until.load(std::memory_order_relaxed);
+    }
+    /* Returns true if the node got frozen by this visit */
+    bool track_stability(const std::array<float, N_ACTIONS>& strategy, float tolerance, uint32_t window,
+                         uint32_t frozen_until) noexcept;
     inline std::array<uint8_t, N_ACTIONS>  get_valid_actions() const noexcept {return m_valid_action_mask;};
 
+    /* Checkpoint epoch of the last change of the node, only nodes changed since the last checkpoint are saved */
+    inline uint32_t get_epoch() const noexcept {
+        return std::atomic_ref<uint32_t>(const_cast<uint32_t&>(m_epoch)).load(std::memory_order_relaxed);
+    }
+    inline void set_epoch(uint32_t epoch) noexcept {
+        std::atomic_ref<uint32_t>(m_epoch).store(epoch, std::memory_order_relaxed);
+    }
+
 private:
-    std::array<float, N_ACTIONS> m_regret_sum;
+    static inline void add_atomic(Counter& c, float f) noexcept {
+        std::atomic_ref<Counter> counter(c);
+        if constexpr (std::is_integral_v<Counter>) {
+            Counter old = counter.load(std::memory_order_relaxed);
+            while (!counter.compare_exchange_weak(old, add_counter(old, f), std::memory_order_relaxed)) {}
+        } else {
+            counter.fetch_add(f, std::memory_order_relaxed);
+        }
+    }
+
+    std::array<Counter, N_ACTIONS> m_regret_sum;
+    /* Strategy at the start of window of stable visits */
     std::array<float, N_ACTIONS> m_strategy;
-    std::array<float, N_ACTIONS> m_strategy_sum;
+    std::array<Counter, N_ACTIONS> m_strategy_sum;
+#if VR_BASELINES
+    std::array<float, N_ACTIONS> m_baseline;
+#endif
     int m_visits, m_visits_2;
+    /* Last DCFR period the node was discounted for */
+    uint32_t m_discount_period;
+    uint32_t m_stable_visits;
+    uint32_t m_frozen_until;
+    uint32_t m_epoch;
     std::array<uint8_t, N_ACTIONS> m_valid_action_mask;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _OPTIONS_H
+#define _OPTIONS_H
+
+#include <string>
+#include <cstddef>
+
+#include "arena.h"
+#include "settings.h"
+#include "topology.h"
+
+enum class GameType{
+    HOLDEM = 0,
+    LEDUC = 1       // small game used to measure exploitability
+};
+
+enum class UpdateMode{
+    LOCKED = 0,     // node is copied out and written back under the tree lock
+    RELAXED = 1     // hogwild - increments are added atomically to shared node, no lock held while updating
+};
+
+enum class Layout{
+    HASH = 0,       // one hash table over full keys
+    PUBLIC = 1,     // nodes grouped by public state, see public_table.h
+    TRIE = 2        // radix tree over keys, see trie.h
+};
+
+enum class Variant{
+    VANILLA = 0,    // plain regret matching, uniform average strategy
+    PLUS = 1,       // regret matching+ (regrets floored at zero) and linear average
+    LINEAR = 2,     // average strategy weighted by iteration
+    DCFR = 3        // discounted CFR, regrets and strategy sums discounted per period of iterations
+};
+
+enum class Sampling{
+    EXTERNAL = 0,   // all hero actions explored, opponent and chance sampled
+    OUTCOME = 1,    // single history sampled, updates importance weighted
+    PUBLIC = 2      // board sampled, all private hands traversed at once (Holdem only)
+};
+
+enum class Dealing{
+    RANDOM = 0,     // every deal shuffled independently
+    STRATIFIED = 1, // deals follow low-discrepancy sequence over hand classes and boards
+    IMPORTANCE = 2  // hero's cards oversampled by regret change, updates importance weighted
+};
+
+enum class HeroSampling{
+    ALL = 0,        // every valid hero action explored
+    AVERAGE = 1     // hero actions sampled by average strategy (AS-MCCFR), at least the most played one explored
+};
+
+/* Runtime options of training, compile time ones are in settings.h */
+struct Options{
+    /* Pre-size game tree for this many nodes, 0 lets the tree grow on its own */
+    size_t expected_nodes = 0;
+    /* Pre-size game tree from number of nodes in saved model */
+    std::string presize_from = "";
+    /* Continue training from checkpoint saved in this file */
+    std::string resume_from = "";
+    /* Backing of node arena */
+    HugePages huge_pages = HugePages::NONE;
+    bool prefault = false;
+    /* Pin training threads to cores, spread over NUMA nodes */
+    bool pin_threads = false;
+    NumaMode numa_mode = NumaMode::NONE;
+    /* Number of training threads, 0 sizes them by CPUs available to the process */
+    unsigned int n_threads = 0;
+    /* File with number of active training threads, checked by monitor to pause/resume threads at runtime */
+    std::string workers_file = "";
+    GameType game = GameType::HOLDEM;
+    UpdateMode update_mode = UpdateMode::LOCKED;
+    /* Number of traversals interleaved on each training thread to hide memory latency */
+    int interleave = 1;
+    /* Number of threads dealing cards and evaluating hands for training threads, 0 lets them deal themselves */
+    int n_dealers = 0;
+    /* Number of partitions of hero's hole cards rotated between training threads, 0 samples all cards */
+    int n_partitions = 0;
+    /* Keep preflop nodes in dense array with per-node locks instead of the game tree */
+    bool hot_tier = false;
+    Layout layout = Layout::HASH;
+    Variant variant = Variant::VANILLA;
+    /* Discount exponents of DCFR for positive regrets, negative regrets and strategy sum */
+    float dcfr_alpha = 1.5;
+    float dcfr_beta = 0;
+    float dcfr_gamma = 2;
+    /* Length of DCFR discount period in iterations */
+    unsigned int discount_every = 100000;
+    /* Hero actions with regret below threshold are not explored, except every explore_every-th iteration (0 prunes
+       them for good) and before iteration prune_after */
+    float prune_threshold = REGRET_TRESHOLD;
+    unsigned int prune_after = 0;
+    unsigned int explore_every = 20;
+    Sampling sampling = Sampling::EXTERNAL;
+    /* Share of uniform exploration in hero's sampling policy in outcome sampling */
+    float os_epsilon = 0.6;
+    Dealing dealing = Dealing::RANDOM;
+    /* Share of natural probability in sampling of hero's cards by importance */
+    float importance_mix = 0.5;
+    /* Leduc exploitability the monitor reports number of iterations for, 0 does not report */
+    float target_exploitability = 0;
+    /* Hero actions explored in external sampling. Action a is sampled with probability
+       max(epsilon, (beta + tau * s[a]) / (beta + sum of s)) where s is strategy sum of the node. */
+    HeroSampling hero_sampling = HeroSampling::ALL;
+    float as_epsilon = 0.05;
+    float as_tau = 1000;
+    float as_beta = 1e6;
+    /* Nodes whose strategy stays within freeze_tolerance over freeze_window visits are not updated for
+       freeze_recheck iterations, 0 tolerance never freezes */
+    float freeze_tolerance = 0;
+    unsigned int freeze_window = 1000;
+    unsigned int freeze_recheck = 1000000;
+    /* Variance reduction - sampled values corrected by per action baselines (needs VR_BASELINES) */
+    bool baselines = false;
+    float baseline_decay = 0.1;
+};
+
+extern Options g_options;
+
+void parse_options(int argc, char** argv);
+void print_usage(const char* program);
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _PARTITION_H
+#define _PARTITION_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#define N_HOLE_COMBOS   1326
+
+/* All hole card combinations ordered by preflop class - higher card, lower card, suited before offsuit */
+const std::vector<std::array<uint8_t, 2>>& hole_combos();
+
+/* Splits hole cards of traversing player into partitions of neighbouring preflop hand classes. Training thread
+   samples hero's cards only from its current partition, so it keeps visiting the same part of the game tree,
+   which stays in its caches. Partition is rotated after number of games proportional to its size, so over a full
+   rotation every hole card combination is sampled equally often and training stays unbiased. */
+class HandPartition{
+public:
+    HandPartition(int n_partitions, int first);
+
+    /* Returns codes of hero's hole cards for the next game */
+    std::array<uint8_t, 2> sample();
+    inline int current() const noexcept {return m_current;};
+
+private:
+    int m_n_partitions;
+    int m_current;
+    int m_begin;
+    int m_end;
+    long int m_games_left;
+    std::mt19937 m_rng;
+
+    void set_partition(int partition) noexcept;
+};
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _PIPELINE_H
+#define _PIPELINE_H
+
+#include <cstdint>
+
+#include "deal.h"
+
+/* Dealer threads shuffle cards and evaluate hands of all rounds ahead of time, training threads take finished
+   deals from their own queue, so they spend their time walking the tree. Every training thread is served by one
+   dealer, one dealer can serve several training threads. */
+void init_pipeline(int n_workers, int n_dealers);
+void stop_pipeline();
+void dealer(int idx);
+
+/* Returns false if no deal is ready, training thread then deals by itself */
+bool take_deal(int worker, Deal& deal);
+/* Number of deals training threads had to prepare themselves */
+uint64_t get_deal_misses();
+
+#endif
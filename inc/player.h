@@ -79,6 +79,9 @@ public:
     inline std::string get_rank_str() const noexcept {return m_rank_str;}
     inline void set_rank_str(const std::string &rank_str) noexcept {m_rank_str = rank_str;}
 
+    inline int get_preflop_class() const noexcept {return m_preflop_class;}
+    inline void set_preflop_class(int preflop_class) noexcept {m_preflop_class = preflop_class;}
+
     inline Rank get_rank() const noexcept {return m_rank;}
     inline void set_rank(Rank rank) noexcept {m_rank = rank;}
 
@@ -127,5 +130,6 @@ private:
     int m_card_idx;
     Rank m_rank;
     std::string m_history;
+    int m_preflop_class = 0;
 };
 #endif
\ No newline at end of file
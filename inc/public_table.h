@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _PUBLIC_TABLE_H
+#define _PUBLIC_TABLE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+#include "node.h"
+#include "settings.h"
+#include "store.h"
+
+/* Nodes grouped by public state. Key is split at the first '-' into card abstraction and public part (betting
+   history, which also determines the round). Public states are found by hash of the public part, each of them
+   holds its own small index over card abstractions, and nodes of one public state are allocated in runs of
+   consecutive arena records. Infosets that differ only in cards thus lie next to each other. */
+class PublicTable : public NodeStore{
+public:
+    PublicTable();
+    ~PublicTable();
+    PublicTable(const PublicTable&) = delete;
+    PublicTable& operator=(const PublicTable&) = delete;
+
+    /* Hash of public part of the key */
+    uint64_t hash_key(const std::string& key) const noexcept override;
+    Node& get(const std::string& key, uint64_t h, bool& inserted) override;
+    const Node* find(const std::string& key) const noexcept override;
+    /* Public states are few and stay in cache, nothing to prefetch */
+    inline void prefetch(uint64_t) const noexcept override {};
+    void for_each(const std::function<void(const std::string&, Node&)>& f) const override;
+
+    void reserve(size_t n_nodes) override;
+    inline void set_page_mode(HugePages huge_pages, bool prefault) noexcept override {
+        m_entries.set_page_mode(huge_pages, prefault);
+    };
+    void set_numa_mode(NumaMode mode, int n_numa_nodes) override;
+
+    inline size_t size() const noexcept override {return m_size;};
+    size_t bytes_used() const noexcept override;
+    size_t bytes_per_node() const noexcept override;
+    /* Number of public states */
+    inline size_t bucket_count() const noexcept override {return m_states.size();};
+
+private:
+    struct Entry{
+        Node node;
+        uint32_t hash;
+        uint8_t length;
+        std::array<char, CARD_KEY_LENGTH> cards;
+    };
+
+    struct PublicState{
+        uint32_t hash;
+        uint32_t next;
+        uint8_t length;
+        std::array<char, KEY_LENGTH> key;
+        /* Open addressing index of entries by card abstraction, 0 is empty slot */
+        uint32_t* index;
+        uint32_t index_mask;
+        uint32_t n_entries;
+        /* Run of arena records being filled and record that did not fit into it, it starts the next run */
+        uint32_t run_next;
+        uint32_t run_end;
+        uint32_t run_spare;
+    };
+
+    static void split(const std::string& key, std::string_view& cards, std::string_view& public_part) noexcept;
+    static uint64_t hash(std::string_view s) noexcept;
+
+    uint32_t find_state(std::string_view public_part, uint64_t h) const noexcept;
+    uint32_t add_state(std::string_view public_part, uint64_t h);
+    uint32_t* find_slot(const PublicState& state, std::string_view cards, uint32_t h) const noexcept;
+    void grow_index(PublicState& state);
+    uint32_t allocate_entry(PublicState& state);
+
+    Arena<Entry> m_entries;
+    Arena<PublicState> m_states;
+    /* Chained buckets of public states, there are few of them so the table is simply rebuilt when it grows */
+    std::vector<uint32_t> m_buckets;
+    size_t m_mask;
+    size_t m_size;
+    size_t m_index_bytes;
+};
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _QUEUE_H
+#define _QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/* Lock-free bounded queue with single producer and single consumer thread. Capacity has to be power of two. */
+template <typename T, size_t CAPACITY>
+class SpscQueue{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "Capacity has to be power of two");
+public:
+    SpscQueue() noexcept : m_head(0), m_tail(0) {}
+
+    /* Producer side, returns false if queue is full */
+    bool push(T&& item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == CAPACITY) return false;
+        m_items[tail & (CAPACITY - 1)] = std::move(item);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    inline bool full() const noexcept {
+        return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_acquire) == CAPACITY;
+    }
+
+    /* Consumer side, returns false if queue is empty */
+    bool pop(T& item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+        item = std::move(m_items[head & (CAPACITY - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, CAPACITY> m_items;
+    /* Producer and consumer counters on separate cache lines */
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _RANGE_H
+#define _RANGE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "card.h"
+#include "deal.h"
+#include "game.h"
+
+/* All private hands a player can hold on one public board, with their card abstraction in every round. Hands of
+   the same abstraction share a node, so they are grouped into buckets. Used by public chance sampling, where one
+   traversal of the betting tree works with values of all hands at once. */
+class Range{
+public:
+    Range();
+
+    /* Hands not blocked by board of the game */
+    void init(const Holdem& game);
+
+    inline size_t size() const noexcept {return m_hands.size();};
+    inline int bucket(int round, size_t hand) const noexcept {return m_buckets[round][hand];};
+    inline size_t n_buckets(int round) const noexcept {return m_bucket_str[round].size();};
+    inline const std::string& bucket_str(int round, int bucket) const noexcept {return m_bucket_str[round][bucket];};
+
+    /* Values of hero's hands against opponent's hands reaching terminal node with given probabilities. Opponent
+       hands sharing a card with hero's hand are left out. Payoff of fold does not depend on cards, showdown
+       pays win, lose or tie by ranks. Both run in linear time. */
+    void fold_values(const std::vector<float>& opp_reach, float payoff, std::vector<float>& values) const;
+    void showdown_values(const std::vector<float>& opp_reach, float win, float lose, float tie,
+                         std::vector<float>& values) const;
+
+private:
+    struct Hand{
+        std::array<uint8_t, 2> cards;
+        uint16_t rank;
+    };
+
+    std::array<Card, 52> m_cards;
+    /* Ordered from the weakest hand to the strongest one */
+    std::vector<Hand> m_hands;
+    std::array<std::vector<int>, N_ROUNDS> m_buckets;
+    std::array<std::vector<std::string>, N_ROUNDS> m_bucket_str;
+};
+
+#endif
@@ -43,6 +43,8 @@ enum class RankCategory {
 class Rank {
 public:
     Rank(){m_value = 0xFFFF;};
+    /* Rank evaluated earlier, usable only for comparison */
+    explicit Rank(uint16_t value) : m_player_cards() {m_value = value;};
     Rank(std::array<Card*, 2> player, const std::array<Card*, 3>& flop);
     Rank(std::array<Card*, 2> player, const std::array<Card*, 3>& flop, Card* turn);
     Rank(std::array<Card*, 2> player, const std::array<Card*, 3>& flop, Card* turn, Card* river);
@@ -55,6 +57,7 @@ public:
     bool operator!=(const Rank& other) const { return m_value != other.m_value; }
 
     std::string get_string_representation() const noexcept;
+    inline uint16_t get_value() const noexcept {return m_value;};
 
 private:
     int hash_nonflush(const uint8_t q[], int k);
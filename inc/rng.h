@@ -0,0 +1,39 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _RNG_H
+#define _RNG_H
+
+#include <cstdint>
+#include <random>
+
+/* Random streams of training and dealing threads. Every generator is seeded from the master seed, the stream of
+   thread it is created on and the number of generators the thread created before. Master seed is saved with
+   checkpoint and resumed run continues from it in a new generation, so the streams are reproducible from the
+   checkpoint but do not replay samples drawn before it. */
+void set_master_seed(uint64_t seed, uint64_t generation);
+uint64_t get_master_seed();
+
+/* Selects stream of the calling thread, each thread should have its own */
+void set_thread_stream(uint64_t stream);
+
+/* Seed for a new generator on the calling thread */
+uint64_t stream_seed();
+
+/* Generator of the calling thread, for code that does not keep its own */
+std::mt19937& thread_rng();
+
+#endif
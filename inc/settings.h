@@ -29,6 +29,40 @@
 #define KEY_LENGTH      35
 
 #define SAVE_EVERY      10
+/* Records read by one loading thread at once when resuming from checkpoint, and how far ahead it prefetches */
+#define LOAD_BLOCK      4096
+#define LOAD_PREFETCH   8
+/* Checkpoint after this many deltas is full again, as well as when deltas outgrow half of the full one */
+#define MAX_DELTAS      8
+/* Size of each of the two buffers of checkpoint writer */
+#define WRITER_BUFFER   (8 << 20)
+
+#define TABLE_MIN_BUCKETS   (1 << 16)
+#define REHASH_STEP         64
+#define ARENA_CHUNK_BITS    20
+#define HUGE_PAGE_SIZE      (2 << 20)
+#define MAX_NUMA_NODES      8
+/* Deals prepared ahead for each training thread, power of two */
+#define DEAL_QUEUE_SIZE     64
+/* Games per hole card combination before training thread moves to the next partition */
+#define PARTITION_ROTATION  64
+/* Card abstraction part of key in public state layout, the rest of longer ones is kept in public part */
+#define CARD_KEY_LENGTH     15
+/* Most nodes allocated for public state at once, so nodes of one public state lie next to each other. Runs grow
+   with number of nodes the public state already has, states with few card abstractions get short ones. */
+#define PUBLIC_RUN          64
+/* Regret-guided chance sampling - weight of new traversal in regret change of stratum and number of traversals
+   between rebuilds of sampling probabilities */
+#define IMPORTANCE_DECAY    0.01f
+#define IMPORTANCE_REBUILD  256
+/* Nodes keep per action baselines for variance reduced MCCFR (--baselines). Baselines are part of node record,
+   so 1 changes format of saved tree - files of one setting cannot be loaded by build with the other. */
+#define VR_BASELINES        0
+/* Pure CFR - every node plays one pure action sampled by regret matching, regrets and strategy sums are integer
+   counters of PURE_CFR_COUNTER type (int32_t or int16_t, saturating). Updates have to be unweighted, so it trains
+   vanilla CFR with external sampling and random or stratified dealing only. 0 keeps float values. */
+#define PURE_CFR            0
+#define PURE_CFR_COUNTER    int32_t
 
 #define REGRET_TRESHOLD -1e4
 #define EPSILON         0.1
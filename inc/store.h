@@ -0,0 +1,59 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _STORE_H
+#define _STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "arena.h"
+#include "node.h"
+#include "topology.h"
+
+/* Storage of game tree nodes. Implementations differ in how nodes are laid out in memory, all of them keep
+   nodes at stable addresses and none of them is thread safe, access has to be guarded by a mutex. Keys are at
+   most KEY_LENGTH long, pad_key() enforces it before any store sees them. */
+class NodeStore{
+public:
+    virtual ~NodeStore() = default;
+
+    /* Hash used by get() and prefetch(), computed before the lock is taken */
+    virtual uint64_t hash_key(const std::string& key) const noexcept = 0;
+    /* Returns node stored under key, creating a new one if it does not exist yet */
+    virtual Node& get(const std::string& key, uint64_t h, bool& inserted) = 0;
+    /* Returns nullptr if there is no node stored under key, never inserts */
+    virtual const Node* find(const std::string& key) const noexcept = 0;
+    /* Hints CPU to load data needed to look up the key, may be called without holding the lock */
+    virtual void prefetch(uint64_t h) const noexcept = 0;
+    virtual void for_each(const std::function<void(const std::string&, Node&)>& f) const = 0;
+
+    /* Pre-size storage for expected number of nodes */
+    virtual void reserve(size_t n_nodes) = 0;
+    /* Have to be called before the first node is inserted */
+    virtual void set_page_mode(HugePages huge_pages, bool prefault) noexcept = 0;
+    virtual void set_numa_mode(NumaMode mode, int n_numa_nodes) = 0;
+
+    virtual size_t size() const noexcept = 0;
+    virtual size_t bytes_used() const noexcept = 0;
+    /* Memory taken by one node including its key and indexing, without space mapped ahead */
+    virtual size_t bytes_per_node() const noexcept = 0;
+    virtual size_t bucket_count() const noexcept = 0;
+};
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _STRATIFIED_H
+#define _STRATIFIED_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+#include "deal.h"
+
+/* Low-discrepancy dealing. Chance events of game k are picked by point frac(shift + k * alpha) of Kronecker
+   sequence with random shift. Every point is uniform in the unit cube, so each game has exactly the distribution
+   of a random deal, but consecutive games spread evenly over the cube. Each coordinate chooses one chance event
+   from outcomes ordered so that similar ones are next to each other, which makes the deals cycle through hand
+   classes and board textures instead of visiting them unevenly. */
+class StratifiedDealer{
+public:
+    StratifiedDealer();
+
+    /* Card codes of Holdem game, hole cards of players in order, then flop, turn and river. Hole cards of the
+       player, flop and turn are stratified, the rest is random. */
+    std::array<uint8_t, N_DEAL_CARDS> deal_holdem(int player);
+    /* Indices to unshuffled Leduc deck of cards of player 0, player 1 and flop card */
+    std::array<int, 3> deal_leduc();
+
+private:
+    std::array<double, 3> next_point() noexcept;
+
+    std::array<double, 3> m_point;
+    std::mt19937 m_rng;
+};
+
+#endif
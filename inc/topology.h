@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _TOPOLOGY_H
+#define _TOPOLOGY_H
+
+#include <cstddef>
+#include <vector>
+
+/* Placement of memory regions other than binding to particular NUMA node */
+#define NUMA_DEFAULT    -2
+#define NUMA_INTERLEAVE -1
+
+enum class NumaMode{
+    NONE = 0,           // leave placement to the kernel
+    INTERLEAVE = 1,     // spread game tree pages evenly over all NUMA nodes
+    PARTITION = 2       // place node created by a thread to memory of NUMA node the thread runs on
+};
+
+struct Topology{
+    /* CPUs belonging to each NUMA node */
+    std::vector<std::vector<int>> nodes;
+};
+
+/* CPUs the process may actually use. In containers, hardware_concurrency() reports cores of the host while
+   the process is limited by affinity mask (cpuset) and CPU quota of its cgroup. */
+struct CpuBudget{
+    unsigned int hardware;
+    unsigned int affinity;
+    /* Quota in CPUs, 0 if not limited */
+    double quota;
+    /* Whole CPUs the process can keep busy */
+    unsigned int available;
+};
+
+CpuBudget detect_cpu_budget();
+void print_cpu_budget(const CpuBudget& budget);
+
+/* Reads NUMA nodes and their CPUs from sysfs, machine without NUMA is reported as single node. Only CPUs in
+   affinity mask of the process are listed. */
+const Topology& get_topology();
+void print_topology(const Topology& topology);
+
+/* CPU for training thread, threads are spread round-robin over NUMA nodes */
+int cpu_for_worker(const Topology& topology, int worker);
+int numa_node_of_cpu(const Topology& topology, int cpu);
+bool pin_thread(int cpu);
+
+/* NUMA node the calling thread was pinned to, 0 if it is not pinned */
+int current_numa_node() noexcept;
+void set_current_numa_node(int node) noexcept;
+
+/* Thread allocations go to the NUMA node the thread runs on */
+void set_local_memory_policy() noexcept;
+/* Binds region to NUMA node or interleaves it over all nodes, must be called before pages are touched */
+void place_region(void* ptr, size_t bytes, int numa_node) noexcept;
+
+#endif
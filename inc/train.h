@@ -16,6 +16,10 @@
  
 #ifndef TRAIN_H
 #define TRAIN_H
-void train();
+void init_tree();
+/* Number of training threads and how many of them run, the rest waits until they are activated */
+void init_workers(int n_workers, int n_active);
+void set_active_workers(int n_active);
+void train(int worker);
 void monitor();
 #endif
\ No newline at end of file
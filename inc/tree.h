@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _TREE_H
+#define _TREE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "arena.h"
+#include "node.h"
+#include "settings.h"
+#include "store.h"
+
+/* Hash table holding game tree nodes. Growing std::unordered_map rehashes all entries at once which stalls
+   every training thread waiting for the lock. Here, new bucket array is allocated when the table gets full and
+   buckets of the old one are migrated a few at a time on every access. Entries live in an arena and are linked
+   by 32-bit indices, they are never moved, so references returned by get() stay valid. The table is not thread
+   safe, access has to be guarded by a mutex. */
+class NodeTable : public NodeStore{
+public:
+    NodeTable();
+    ~NodeTable();
+    NodeTable(const NodeTable&) = delete;
+    NodeTable& operator=(const NodeTable&) = delete;
+
+    static uint64_t hash(const std::string& key) noexcept;
+    inline uint64_t hash_key(const std::string& key) const noexcept override {return hash(key);};
+
+    /* Returns node stored under key, creating a new one if it does not exist yet */
+    Node& get(const std::string& key, bool& inserted);
+    Node& get(const std::string& key, uint64_t h, bool& inserted) override;
+
+    /* Loads bucket of the key. Bucket array and mask may belong to different sizes of the table while it grows,
+       prefetch of a wrong address does not fault. */
+    inline void prefetch(uint64_t h) const noexcept override {
+        NodeTable& self = const_cast<NodeTable&>(*this);
+        uint32_t* buckets = std::atomic_ref<uint32_t*>(self.m_buckets).load(std::memory_order_relaxed);
+        size_t mask = std::atomic_ref<size_t>(self.m_mask).load(std::memory_order_relaxed);
+        __builtin_prefetch(buckets + (h & mask));
+    }
+
+    const Node* find(const std::string& key) const noexcept override;
+
+    /* Pre-size table for expected number of nodes so it does not have to grow at all */
+    void reserve(size_t n_nodes) override;
+    inline void set_page_mode(HugePages huge_pages, bool prefault) noexcept override {
+        m_entries.set_page_mode(huge_pages, prefault);
+    };
+    void set_numa_mode(NumaMode mode, int n_numa_nodes) override;
+
+    inline size_t size() const noexcept override {return m_entries.size();};
+    inline size_t bytes_used() const noexcept override {
+        return m_entries.bytes_mapped() + (m_mask + 1 + (m_old ? m_old_mask + 1 : 0)) * sizeof(uint32_t);
+    };
+    inline size_t bytes_per_node() const noexcept override {
+        return size() == 0 ? 0 : sizeof(Entry) + (m_mask + 1) * sizeof(uint32_t) / size();
+    };
+    inline size_t bucket_count() const noexcept override {return m_mask + 1;};
+    inline bool is_rehashing() const noexcept {return m_old != nullptr;};
+
+    void for_each(const std::function<void(const std::string&, Node&)>& f) const override {
+        for (int t = 0; t < 2; t++) {
+            uint32_t* buckets = t == 0 ? m_old : m_buckets;
+            size_t n_buckets = t == 0 ? m_old_mask + 1 : m_mask + 1;
+            if (buckets == nullptr) continue;
+            for (size_t i = 0; i < n_buckets; i++) {
+                for (uint32_t idx = buckets[i]; idx != Arena<Entry>::NONE; idx = m_entries.at(idx).next) {
+                    Entry& e = m_entries.at(idx);
+                    f(std::string(e.key.data(), e.length), e.node);
+                }
+            }
+        }
+    }
+
+private:
+    struct Entry{
+        Node node;
+        /* Lower half of the hash is enough to find bucket, table never has more than 2^32 buckets */
+        uint32_t hash;
+        uint32_t next;
+        uint8_t length;
+        std::array<char, KEY_LENGTH> key;
+    };
+
+    static bool matches(const Entry& e, const std::string& key, uint64_t h) noexcept;
+    uint32_t* allocate_buckets(size_t n_buckets);
+    static void free_buckets(uint32_t* buckets, size_t n_buckets) noexcept;
+
+    void start_rehash(size_t n_buckets);
+    void rehash_step(int n_buckets) noexcept;
+
+    Arena<Entry> m_entries;
+    NumaMode m_numa_mode;
+    uint32_t* m_buckets;
+    size_t m_mask;
+
+    /* Bucket array being migrated, nullptr if no rehash is in progress */
+    uint32_t* m_old;
+    size_t m_old_mask;
+    size_t m_rehash_idx;
+};
+
+#endif
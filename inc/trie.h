@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _TRIE_H
+#define _TRIE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "node.h"
+#include "settings.h"
+#include "store.h"
+#include "writer.h"
+
+/* Radix tree over keys. Keys share long prefixes (card abstraction followed by betting history), so each prefix
+   is stored once as an edge label and only the differing suffixes take extra space. Game tree nodes are the
+   payload of trie nodes where a key ends. Padding of keys is not stored. Lookup walks the key character by
+   character, which is slower than hash table, the trie trades speed for memory. */
+class TrieTable : public NodeStore{
+public:
+    TrieTable();
+    TrieTable(const TrieTable&) = delete;
+    TrieTable& operator=(const TrieTable&) = delete;
+
+    /* Trie does not hash keys */
+    inline uint64_t hash_key(const std::string&) const noexcept override {return 0;};
+    Node& get(const std::string& key, uint64_t, bool& inserted) override;
+    const Node* find(const std::string& key) const noexcept override;
+    inline void prefetch(uint64_t) const noexcept override {};
+    void for_each(const std::function<void(const std::string&, Node&)>& f) const override;
+
+    void reserve(size_t n_nodes) override;
+    inline void set_page_mode(HugePages huge_pages, bool prefault) noexcept override {
+        m_payloads.set_page_mode(huge_pages, prefault);
+    };
+    inline void set_numa_mode(NumaMode mode, int n_numa_nodes) override {
+        m_payloads.set_numa_mode(mode, n_numa_nodes);
+    };
+
+    inline size_t size() const noexcept override {return m_payloads.size();};
+    size_t bytes_used() const noexcept override;
+    size_t bytes_per_node() const noexcept override;
+    /* Number of trie nodes */
+    inline size_t bucket_count() const noexcept override {return m_trie.size();};
+
+    /* On-disk form - trie nodes in pre-order, each with its label, number of children and optional payload,
+       followed by nodes kept outside of the trie (hot tier) as padded key and node. Save writes aside and renames,
+       so the previous file is kept if it fails. Load has to be done into empty trie, nodes outside are inserted
+       into the trie. Both return false on failure. */
+    bool save(const std::string& path, const std::vector<std::pair<std::string, Node>>& outside) const;
+    bool load(const std::string& path);
+    /* Returns number of game tree nodes in saved trie, 0 if the file is not a saved trie */
+    static size_t count_saved(const std::string& path);
+
+private:
+    struct TrieNode{
+        uint32_t child;
+        uint32_t sibling;
+        uint32_t label;
+        uint32_t payload;
+        uint8_t length;
+    };
+
+    static std::string_view strip(const std::string& key) noexcept;
+    inline const char* label(const TrieNode& n) const noexcept {
+        return m_labels[n.label >> LABEL_CHUNK_BITS].get() + (n.label & ((1u << LABEL_CHUNK_BITS) - 1));
+    };
+    uint32_t add_label(std::string_view s);
+    uint32_t add_node(uint32_t label, uint8_t length);
+    uint32_t find_child(uint32_t parent, char c, uint32_t& prev) const noexcept;
+
+    void save_node(BufferedWriter& f, uint32_t idx) const;
+    /* Returns NONE if the file is truncated */
+    uint32_t load_node(FILE* f);
+    void visit(uint32_t idx, std::string& prefix, const std::function<void(const std::string&, Node&)>& f) const;
+
+    static constexpr int LABEL_CHUNK_BITS = 20;
+
+    Arena<TrieNode> m_trie;
+    Arena<Node> m_payloads;
+    uint32_t m_root;
+    /* Labels are appended to fixed size chunks, so they never move */
+    std::vector<std::unique_ptr<char[]>> m_labels;
+    size_t m_label_bytes;
+};
+
+#endif
@@ -18,12 +18,37 @@
 #include "node.h"
 #include "settings.h"
 #include "game.h"
+#include "store.h"
+#include "hot.h"
 
 int get_ram_usage();
 
 std::string pad_string(const std::string& str, int length);
+/* Pads key of game tree node to KEY_LENGTH, all keys given to node stores are made by it. Longer key would have
+   to be truncated and could merge distinct infosets, so it ends the program - KEY_LENGTH has to be raised then. */
+std::string pad_key(const std::string& key);
 
-void saveModel(std::unordered_map<std::string, Node>& tree);
+/* Saves nodes changed after since_epoch, all nodes if it is 0. Text dump is written only with all nodes. Returns
+   false if the model could not be written, previous saved model is kept then. */
+bool saveModel(const NodeStore& tree, const HotTier& hot, const std::string& path = "tree", uint32_t since_epoch = 0);
+size_t count_saved_nodes(const std::string& path);
+
+/* Inserts nodes saved by saveModel() into tree, reading with n_threads threads. Node already in the tree is
+   replaced only by one of the same or later epoch, so checkpoint files can be loaded in any order. Sets number of
+   nodes in the file, returns false if it cannot be opened or read completely. */
+bool load_checkpoint(const std::string& path, NodeStore& tree, int n_threads, size_t& n_records);
+
+/* Progress of training saved next to the game tree, so training can be resumed from checkpoint */
+struct TrainingState{
+    unsigned int iterations = 0;
+    /* Master seed of random streams */
+    uint64_t seed = 0;
+    /* Nodes changed up to this epoch are saved, in the full checkpoint or in one of n_deltas deltas after it */
+    uint32_t epoch = 0;
+    unsigned int n_deltas = 0;
+};
+bool save_training_state(const std::string& path, const TrainingState& state);
+bool load_training_state(const std::string& path, TrainingState& state);
 std::unordered_map<std::string, Node> loadModel();
 
 void store_card_combination_key(std::string key, std::vector<std::string> &keys);
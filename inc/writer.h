@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _WRITER_H
+#define _WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "settings.h"
+
+/* Writes file through a dedicated thread. Data are collected in one buffer while the other one is being written,
+   so producer does not wait for the disk unless it is faster than the disk. Not thread safe on producer side. */
+class BufferedWriter{
+public:
+    explicit BufferedWriter(const std::string& path, size_t buffer_size = WRITER_BUFFER);
+    ~BufferedWriter();
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    inline bool is_open() const noexcept {return m_fd >= 0;};
+    void write(const void* data, size_t n);
+    /* Writes out the rest of data, syncs it to disk and closes the file, returns false if anything could not be
+       written */
+    bool close();
+
+private:
+    void run();
+    /* Passes filled buffer to the writing thread */
+    void hand_off();
+
+    int m_fd;
+    std::vector<char> m_filling;
+    std::vector<char> m_writing;
+    size_t m_used;
+    size_t m_write_size;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    /* Buffer waiting for or being written by the thread */
+    bool m_pending;
+    bool m_done;
+    bool m_failed;
+    std::thread m_thread;
+};
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "arena.h"
+#include "topology.h"
+
+#include <iostream>
+#include <sys/mman.h>
+
+static void prefault_region(void* ptr, size_t bytes) {
+    volatile char* p = static_cast<char*>(ptr);
+    for (size_t i = 0; i < bytes; i += 4096) p[i] = 0;
+}
+
+void* map_region(size_t bytes, HugePages huge_pages, bool prefault, int numa_node) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+
+    /* Pages are faulted in by touching rather than MAP_POPULATE, so NUMA placement and madvise apply to them */
+    if (huge_pages == HugePages::EXPLICIT) {
+        /* Without MAP_NORESERVE, so mapping fails right away instead of SIGBUS on access when the pool is empty */
+        int huge_flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, huge_flags, -1, 0);
+        if (ptr != MAP_FAILED) {
+            place_region(ptr, bytes, numa_node);
+            if (prefault) prefault_region(ptr, bytes);
+            return ptr;
+        }
+
+        static bool warned = false;
+        if (!warned) {
+            std::cout << "Explicit huge pages not available, using transparent ones.\n";
+            warned = true;
+        }
+        huge_pages = HugePages::TRANSPARENT;
+    }
+
+    void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (ptr == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    if (huge_pages == HugePages::TRANSPARENT) {
+        madvise(ptr, bytes, MADV_HUGEPAGE);
+    }
+    place_region(ptr, bytes, numa_node);
+    if (prefault) prefault_region(ptr, bytes);
+    return ptr;
+}
+
+void unmap_region(void* ptr, size_t bytes) noexcept { munmap(ptr, bytes); }
@@ -15,11 +15,11 @@
  */
  
 #include <algorithm>
-#include <chrono>
 #include <iostream>
 #include <random>
 
 #include "deck.h"
+#include "rng.h"
 
 Deck::Deck() {
     m_pointer_to_deck = 0;
@@ -30,8 +30,27 @@ Deck::Deck() {
 };
 
 void Deck::shuffle() noexcept {
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::default_random_engine rng(seed);
     m_pointer_to_deck = 0;
-    std::shuffle(m_cards.begin(), m_cards.end(), rng);
+    std::shuffle(m_cards.begin(), m_cards.end(), thread_rng());
+};
+
+void Deck::arrange(const std::array<uint8_t, N_DEAL_CARDS>& codes) noexcept {
+    m_pointer_to_deck = 0;
+    for (int i = 0; i < N_DEAL_CARDS; i++) {
+        for (int j = i; j < 52; j++) {
+            if (m_cards[j].get_code() == codes[i]) {
+                std::swap(m_cards[i], m_cards[j]);
+                break;
+            }
+        }
+    }
+};
+
+void Deck::place(int position, uint8_t code) noexcept {
+    for (int j = 0; j < 52; j++) {
+        if (m_cards[j].get_code() == code) {
+            std::swap(m_cards[position], m_cards[j]);
+            return;
+        }
+    }
 };
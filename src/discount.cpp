@@ -0,0 +1,40 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "discount.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DiscountTable::init(double alpha, double beta, double gamma) {
+    m_positive.assign(MAX_DISCOUNT_PERIODS + 1, 0);
+    m_negative.assign(MAX_DISCOUNT_PERIODS + 1, 0);
+    m_strategy.assign(MAX_DISCOUNT_PERIODS + 1, 0);
+    for (size_t t = 1; t <= MAX_DISCOUNT_PERIODS; t++) {
+        double ta = std::pow(t, alpha), tb = std::pow(t, beta);
+        m_positive[t] = m_positive[t - 1] + std::log(ta / (ta + 1));
+        m_negative[t] = m_negative[t - 1] + std::log(tb / (tb + 1));
+        m_strategy[t] = m_strategy[t - 1] + gamma * std::log(static_cast<double>(t) / (t + 1));
+    }
+}
+
+DiscountTable::Factors DiscountTable::between(uint32_t from, uint32_t to) const noexcept {
+    from = std::min<uint32_t>(from, MAX_DISCOUNT_PERIODS);
+    to = std::min<uint32_t>(to, MAX_DISCOUNT_PERIODS);
+    return {static_cast<float>(std::exp(m_positive[to] - m_positive[from])),
+            static_cast<float>(std::exp(m_negative[to] - m_negative[from])),
+            static_cast<float>(std::exp(m_strategy[to] - m_strategy[from]))};
+}
@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "exploitability.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "leduc.h"
+#include "settings.h"
+
+/* Game with probability of reaching it by chance and opponent's average strategy */
+struct WeightedGame{
+    std::unique_ptr<Leduc> game;
+    double weight;
+};
+
+static std::array<float, N_ACTIONS> average_strategy(const NodeLookup& lookup, Leduc& game, int player) {
+    Node node;
+    std::array<uint8_t, N_ACTIONS> mask = game.get_valid_actions_mask(player);
+    std::array<float, N_ACTIONS> strategy;
+    bool found = lookup(game.create_key(player), node);
+    if (found) strategy = node.get_average_strategy();
+
+    /* Average strategy is spread over all actions if node has no strategy sum yet */
+    float sum = 0;
+    for (int i = 0; i < N_ACTIONS; i++) {
+        if (!found) strategy[i] = 1;
+        strategy[i] *= mask[i];
+        sum += strategy[i];
+    }
+    for (int i = 0; i < N_ACTIONS; i++) {
+        strategy[i] = sum > 0 ? strategy[i] / sum : mask[i];
+    }
+    return strategy;
+}
+
+/* All games share public history, they differ in cards only. Returns sum of weighted values of best
+   response player over all games. */
+static double best_response(std::vector<WeightedGame>& games, int br_player, const NodeLookup& lookup) {
+    if (!games[0].game->is_running()) {
+        double value = 0;
+        for (WeightedGame& g : games) value += g.weight * g.game->get_reward(br_player);
+        return value;
+    }
+
+    int player = 0;
+    for (WeightedGame& g : games) player = g.game->next_player();
+    std::vector<Action> valid = games[0].game->get_valid_actions(player);
+
+    if (player == br_player) {
+        /* Best response player knows only own information set, choose the best action for each one */
+        std::map<std::string, std::vector<WeightedGame*>> infosets;
+        for (WeightedGame& g : games) infosets[g.game->create_key(player)].push_back(&g);
+
+        double value = 0;
+        for (auto& [key, infoset] : infosets) {
+            double best = -1e30;
+            for (Action& a : valid) {
+                std::vector<WeightedGame> children;
+                for (WeightedGame* g : infoset) {
+                    children.push_back({std::make_unique<Leduc>(*g->game), g->weight});
+                    children.back().game->take_action(a);
+                }
+                best = std::max(best, best_response(children, br_player, lookup));
+            }
+            value += best;
+        }
+        return value;
+    }
+
+    /* Opponent plays its average strategy, its action is public so each one is explored separately */
+    std::vector<std::array<float, N_ACTIONS>> strategies;
+    for (WeightedGame& g : games) strategies.push_back(average_strategy(lookup, *g.game, player));
+
+    double value = 0;
+    for (Action& a : valid) {
+        std::vector<WeightedGame> children;
+        for (size_t i = 0; i < games.size(); i++) {
+            double weight = games[i].weight * strategies[i][int(a)];
+            if (weight <= 0) continue;
+            children.push_back({std::make_unique<Leduc>(*games[i].game), weight});
+            children.back().game->take_action(a);
+        }
+        if (!children.empty()) value += best_response(children, br_player, lookup);
+    }
+    return value;
+}
+
+float leduc_exploitability(const NodeLookup& lookup) {
+    double value = 0;
+    for (int br_player = 0; br_player < 2; br_player++) {
+        std::vector<WeightedGame> games;
+        for (int c0 = 0; c0 < 6; c0++) {
+            for (int c1 = 0; c1 < 6; c1++) {
+                for (int flop = 0; flop < 6; flop++) {
+                    if (c0 == c1 || c0 == flop || c1 == flop) continue;
+                    games.push_back({std::make_unique<Leduc>(BIG_BLIND, SMALL_BLIND, MAX_RERAISES), 1.0 / 120.0});
+                    games.back().game->start_game({c0, c1, flop});
+                }
+            }
+        }
+        value += best_response(games, br_player, lookup);
+    }
+    return static_cast<float>(value / 2);
+}
@@ -23,6 +23,7 @@
 #include "game.h"
 #include "deck.h"
 #include "player.h"
+#include "rng.h"
 #include "settings.h"
 #include "utils.h"
 
@@ -32,7 +33,8 @@ Holdem::Holdem(uint8_t n_players, uint16_t big_bling, uint16_t small_blind, uint
     , m_small_blind(small_blind)
     , m_max_reraises(max_reraises)
     , m_winner({-1})
-    , m_deck(Deck()) {
+    , m_deck(Deck())
+    , m_deal(nullptr) {
     m_actions = {Action(0, 'p', 0), Action(1, 'c', 0), Action(2, 'A', 1),
                  Action(3, 'B', 2), Action(4, 'C', 3), Action(5, 'D', 5)};
 };
@@ -52,13 +54,61 @@ Holdem::Holdem(Holdem &h)
     , m_turn(h.m_turn)
     , m_river(h.m_river)
     , m_players(h.m_players)
-    , m_actions(h.m_actions) {
+    , m_actions(h.m_actions)
+    , m_deal(h.m_deal) {
     update_ranks();
 }
 
 void Holdem::start_game() {
     m_deck.shuffle();
+    m_deal = nullptr;
+    deal_cards();
+}
+
+void Holdem::start_game(const Deal& deal) {
+    m_deck.arrange(deal.cards);
+    m_deal = &deal;
+    deal_cards();
+}
+
+void Holdem::start_game(const std::array<uint8_t, N_DEAL_CARDS>& cards) {
+    m_deck.arrange(cards);
+    m_deal = nullptr;
+    deal_cards();
+}
 
+void Holdem::start_game(int8_t player, const std::array<uint8_t, 2>& hole) {
+    m_deck.shuffle();
+    /* Players draw their cards in order, two each */
+    m_deck.place(2 * player, hole[0]);
+    m_deck.place(2 * player + 1, hole[1]);
+    m_deal = nullptr;
+    deal_cards();
+}
+
+void Holdem::prepare_deal(Deal& deal) {
+    start_game();
+    for (int i = 0; i < N_PLAYERS; i++) {
+        deal.cards[2 * i] = m_players[i].get_cards()[0]->get_code();
+        deal.cards[2 * i + 1] = m_players[i].get_cards()[1]->get_code();
+    }
+    for (int i = 0; i < 3; i++) {
+        deal.cards[2 * N_PLAYERS + i] = m_flop[i]->get_code();
+    }
+    deal.cards[2 * N_PLAYERS + 3] = m_turn->get_code();
+    deal.cards[2 * N_PLAYERS + 4] = m_river->get_code();
+
+    for (int r = 0; r < N_ROUNDS; r++) {
+        m_round = static_cast<Round>(r);
+        update_ranks();
+        for (int i = 0; i < N_PLAYERS; i++) {
+            deal.rank_str[i][r] = m_players[i].get_rank_str();
+            deal.rank[i][r] = m_players[i].get_rank().get_value();
+        }
+    }
+}
+
+void Holdem::deal_cards() {
     for (int8_t i = 0; i < m_n_players; i++) {
         PlayerState state = (i < m_n_players - 1) ? PlayerState::TO_CALL : PlayerState::NO_ACTION;
         int bet = m_big_blind;
@@ -201,21 +251,57 @@ bool Holdem::can_raise(uint8_t player_idx, const Action &a) const noexcept {
     return reraise_allowed && !bet_too_low;
 }
 
+/* Pairs on diagonal, suited hands above it and offsuit below */
+static int preflop_class(const std::array<Card *, 2> &cards) {
+    int hi = std::max(cards[0]->get_value(), cards[1]->get_value()) - 2;
+    int lo = std::min(cards[0]->get_value(), cards[1]->get_value()) - 2;
+    return cards[0]->get_suit() == cards[1]->get_suit() ? hi * 13 + lo : lo * 13 + hi;
+}
+
+static std::string preflop_str(const std::array<Card *, 2> &cards) {
+    std::string rank_str = "";
+    if (*cards[0] > *cards[1]) {
+        rank_str += cards[0]->get_value_str();
+        rank_str += cards[1]->get_value_str();
+    } else {
+        rank_str += cards[1]->get_value_str();
+        rank_str += cards[0]->get_value_str();
+    }
+    rank_str.append(cards[0]->get_suit() == cards[1]->get_suit() ? "s" : "o");
+    return rank_str;
+}
+
+void Holdem::evaluate_hole(const std::array<Card*, 2>& hole, std::array<std::string, N_ROUNDS>& rank_str,
+                           uint16_t& rank) const {
+    rank_str[static_cast<int>(Round::PREFLOP)] = preflop_str(hole);
+    Rank flop(hole, m_flop);
+    rank_str[static_cast<int>(Round::FLOP)] = flop.get_string_representation();
+    Rank turn(hole, m_flop, m_turn);
+    rank_str[static_cast<int>(Round::TURN)] = turn.get_string_representation();
+    /* Game is decided by ranks of the last round played */
+    rank = turn.get_value();
+}
+
 void Holdem::update_ranks() {
+    if (m_deal != nullptr && static_cast<int>(m_round) < N_ROUNDS) {
+        int r = static_cast<int>(m_round);
+        for (int i = 0; i < m_n_players; i++) {
+            m_players[i].set_rank_str(m_deal->rank_str[i][r]);
+            if (m_round == Round::PREFLOP) {
+                m_players[i].set_preflop_class(preflop_class(m_players[i].get_cards()));
+            } else {
+                m_players[i].set_rank(Rank(m_deal->rank[i][r]));
+            }
+        }
+        return;
+    }
+
     Rank rank;
     for (Player &p : m_players) {
         if (m_round == Round::PREFLOP) {
-            std::string rank_str = "";
             const std::array<Card *, 2> &cards = p.get_cards();
-            if (*cards[0] > *cards[1]) {
-                rank_str += cards[0]->get_value_str();
-                rank_str += cards[1]->get_value_str();
-            } else {
-                rank_str += cards[1]->get_value_str();
-                rank_str += cards[0]->get_value_str();
-            }
-            rank_str.append(cards[0]->get_suit() == cards[1]->get_suit() ? "s" : "o");
-            p.set_rank_str(rank_str);
+            p.set_rank_str(preflop_str(cards));
+            p.set_preflop_class(preflop_class(cards));
         } else {
             if (m_round == Round::FLOP) {
                 rank = Rank(p.get_cards(), m_flop);
@@ -358,8 +444,7 @@ std::vector<Action> Holdem::get_valid_actions(int player){
 /* TODO strategy as reference or not? */
 Action Holdem::sample_action(const std::array<float, N_ACTIONS>& strategy, const std::array<uint8_t, N_ACTIONS>& valid, uint8_t player){
     std::uniform_real_distribution<double> unif(0, 1);
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937& gen = thread_rng();
     std::array<float, N_ACTIONS> s;
 
     if (unif(gen) > EPSILON){
@@ -375,19 +460,23 @@ Action Holdem::sample_action(const std::array<float, N_ACTIONS>& strategy, const
 }
 
 Action Holdem::sample_action(const std::array<float, N_ACTIONS>& strategy, uint8_t player){
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937& gen = thread_rng();
     std::discrete_distribution<> d(strategy.begin(), strategy.end());
     int a = d(gen);
     return m_actions[a];
 }
 std::string Holdem::create_key(uint8_t player)
+{
+    return create_key(player, get_player_cards_str(player));
+}
+
+std::string Holdem::create_key(uint8_t player, const std::string& cards_str)
 {
     std::string key;
-    key.append(get_player_cards_str(player));
+    key.append(cards_str);
     key.append(m_players[player].get_history_without_current_round());
     key.append(m_history);
-    return pad_string(key, KEY_LENGTH);
+    return pad_key(key);
 }
 
 int Holdem::count_remaining_players() noexcept{
@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "hot.h"
+
+#include <algorithm>
+
+#include "card.h"
+#include "utils.h"
+
+/* Every action takes 7 bits, longer histories are not stored in the hot tier */
+#define HOT_HISTORY_LENGTH  4
+
+uint32_t HotTier::encode(const std::string& history) noexcept {
+    uint32_t code = 0;
+    for (char c : history) code = (code << 7) | static_cast<uint8_t>(c & 0x7F);
+    /* Distinguishes empty history from history of action with code 0 */
+    return (code << 3) | static_cast<uint32_t>(history.size());
+}
+
+void HotTier::collect_histories(Holdem& game) {
+    if (!game.is_running() || game.get_round() != Round::PREFLOP) return;
+    if (game.get_history().size() > HOT_HISTORY_LENGTH) return;
+
+    int player = game.next_player();
+    /* Part of key following the cards, without padding */
+    std::string suffix = game.create_key(player, "");
+    suffix.erase(suffix.find_last_not_of(' ') + 1);
+    m_suffixes.push_back({encode(game.get_history()), suffix});
+    for (const Action& a : game.get_valid_actions(player)) {
+        Holdem game_copy = Holdem(game);
+        game_copy.take_action(a);
+        collect_histories(game_copy);
+    }
+}
+
+void HotTier::init() {
+    /* Betting does not depend on cards, any deal will do */
+    Holdem game(N_PLAYERS, BIG_BLIND, SMALL_BLIND, MAX_RERAISES);
+    game.start_game();
+    collect_histories(game);
+
+    std::sort(m_suffixes.begin(), m_suffixes.end());
+    m_suffixes.erase(std::unique(m_suffixes.begin(), m_suffixes.end()), m_suffixes.end());
+    for (const auto& s : m_suffixes) m_histories.push_back(s.first);
+    m_n_histories = m_histories.size();
+    m_entries = std::make_unique<HotEntry[]>(m_n_histories * N_PREFLOP_CLASSES);
+}
+
+std::string HotTier::entry_key(size_t idx) const {
+    /* Inverse of preflop class - suited hands above diagonal, offsuit ones and pairs on and below it */
+    int c = static_cast<int>(idx % N_PREFLOP_CLASSES);
+    int hi = c / 13, lo = c % 13;
+    bool suited = hi > lo;
+    if (!suited) std::swap(hi, lo);
+
+    std::string key;
+    key += Card(hi * 4).get_value_str();
+    key += Card(lo * 4).get_value_str();
+    key += suited ? 's' : 'o';
+    key += m_suffixes[idx / N_PREFLOP_CLASSES].second;
+    return pad_key(key);
+}
+
+HotEntry* HotTier::find(const Holdem& game, uint8_t player) noexcept {
+    if (m_n_histories == 0 || game.get_round() != Round::PREFLOP) return nullptr;
+    const std::string& history = game.get_history();
+    if (history.size() > HOT_HISTORY_LENGTH) return nullptr;
+
+    auto it = std::lower_bound(m_histories.begin(), m_histories.end(), encode(history));
+    if (it == m_histories.end() || *it != encode(history)) return nullptr;
+    size_t idx = static_cast<size_t>(it - m_histories.begin()) * N_PREFLOP_CLASSES + game.get_preflop_class(player);
+    return &m_entries[idx];
+}
@@ -0,0 +1,106 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "importance.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "partition.h"
+#include "rng.h"
+#include "settings.h"
+
+ChanceImportance::ChanceImportance(std::vector<float> probabilities, float mix)
+    : m_probabilities(std::move(probabilities))
+    , m_scores(m_probabilities.size(), 1)
+    , m_sampling(m_probabilities)
+    , m_distribution(m_sampling.begin(), m_sampling.end())
+    , m_mix(std::clamp(mix, 0.0f, 1.0f))
+    , m_updates(0)
+    , m_rng(stream_seed()) {}
+
+int ChanceImportance::sample(float& weight) {
+    int stratum = m_distribution(m_rng);
+    weight = m_probabilities[stratum] / m_sampling[stratum];
+    return stratum;
+}
+
+void ChanceImportance::update(int stratum, float regret_change) noexcept {
+    m_scores[stratum] += IMPORTANCE_DECAY * (regret_change - m_scores[stratum]);
+    if (++m_updates % IMPORTANCE_REBUILD == 0) rebuild();
+}
+
+void ChanceImportance::rebuild() {
+    /* q = p * (mix + (1 - mix) * score / mean score), sums to one. Natural share keeps every stratum sampled,
+       so its score keeps being refreshed and the weight p / q stays bounded by 1 / mix. */
+    float mean = 0;
+    for (size_t i = 0; i < m_scores.size(); i++) mean += m_probabilities[i] * m_scores[i];
+    if (mean <= 0) return;
+    for (size_t i = 0; i < m_scores.size(); i++) {
+        m_sampling[i] = m_probabilities[i] * (m_mix + (1 - m_mix) * m_scores[i] / mean);
+    }
+    m_distribution = std::discrete_distribution<int>(m_sampling.begin(), m_sampling.end());
+}
+
+static std::vector<std::array<int, 2>> class_ranges() {
+    /* Combos are ordered by class, class changes with values or suitedness */
+    const std::vector<std::array<uint8_t, 2>>& combos = hole_combos();
+    auto klass = [](const std::array<uint8_t, 2>& h) {
+        return (h[0] >> 2) * 64 + (h[1] >> 2) * 2 + ((h[0] & 3) == (h[1] & 3));
+    };
+    std::vector<std::array<int, 2>> ranges;
+    for (int i = 0; i < N_HOLE_COMBOS; i++) {
+        if (i == 0 || klass(combos[i]) != klass(combos[i - 1])) ranges.push_back({i, i});
+        ranges.back()[1] = i + 1;
+    }
+    return ranges;
+}
+
+static std::vector<float> class_probabilities(const std::vector<std::array<int, 2>>& ranges) {
+    std::vector<float> p;
+    for (const std::array<int, 2>& r : ranges) p.push_back(static_cast<float>(r[1] - r[0]) / N_HOLE_COMBOS);
+    return p;
+}
+
+HoldemImportance::HoldemImportance(float mix)
+    : m_classes(class_ranges())
+    , m_importance(class_probabilities(m_classes), mix)
+    , m_rng(stream_seed()) {}
+
+std::array<uint8_t, 2> HoldemImportance::sample(int& stratum, float& weight) {
+    stratum = m_importance.sample(weight);
+    std::uniform_int_distribution<int> combo(m_classes[stratum][0], m_classes[stratum][1] - 1);
+    return hole_combos()[combo(m_rng)];
+}
+
+LeducImportance::LeducImportance(float mix)
+    : m_importance({1.0f / 3, 1.0f / 3, 1.0f / 3}, mix)
+    , m_rng(stream_seed()) {}
+
+std::array<int, 3> LeducImportance::sample(int hero, int& stratum, float& weight) {
+    /* Unshuffled deck holds both suits of a rank next to each other */
+    stratum = m_importance.sample(weight);
+    int card = 2 * stratum + std::uniform_int_distribution<int>(0, 1)(m_rng);
+
+    std::vector<int> rest;
+    for (int i = 0; i < 6; i++) {
+        if (i != card) rest.push_back(i);
+    }
+    std::shuffle(rest.begin(), rest.end(), m_rng);
+    std::array<int, 3> deal = {rest[0], rest[1], rest[2]};
+    deal[hero] = card;
+    return deal;
+}
@@ -19,10 +19,10 @@
 #include <cstdint>
 #include <random>
 #include <algorithm>
-#include <chrono>
 
 #include "leduc.h"
 #include "player.h"
+#include "rng.h"
 #include "settings.h"
 #include "utils.h"
 
@@ -57,15 +57,31 @@ Leduc::Leduc(Leduc &h)
 }
 
 void Leduc::shuffle_cards() {    
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::default_random_engine rng(seed);
     m_pointer_to_deck = 0;
-    std::shuffle(m_deck.begin(), m_deck.end(), rng);
+    std::shuffle(m_deck.begin(), m_deck.end(), thread_rng());
 }
 
 void Leduc::start_game() {
     shuffle_cards();
+    deal();
+}
 
+void Leduc::start_game(const std::array<int, 3>& deal_idx) {
+    std::array<Card, 6> deck = m_deck;
+    std::array<bool, 6> used{};
+    int pos = 0;
+    for (int idx : deal_idx) {
+        m_deck[pos++] = deck[idx];
+        used[idx] = true;
+    }
+    for (int i = 0; i < 6; i++) {
+        if (!used[i]) m_deck[pos++] = deck[i];
+    }
+    m_pointer_to_deck = 0;
+    deal();
+}
+
+void Leduc::deal() {
     for (int8_t i = 0; i < m_n_players; i++) {
         PlayerState state = (i < m_n_players - 1) ? PlayerState::TO_CALL : PlayerState::IN;
         int bet = i == 0 ? m_small_blind : m_big_blind;
@@ -75,7 +91,7 @@ void Leduc::start_game() {
     }
 
     m_current_player = 0;
-    m_round = Round::PREFLOP;
+    m_round = LeducRound::PREFLOP;
     // m_history = "-";
     m_winner = -1;
 
@@ -164,7 +180,7 @@ void Leduc::take_action(const Action &a) {
 
     if (is_round_end()) {
         next_round();
-        if (m_round == Round::REVEAL) {
+        if (m_round == LeducRound::REVEAL) {
             m_winner = find_winner();
         } else {
             compress_history();
@@ -189,7 +205,7 @@ bool Leduc::can_raise(uint8_t player_idx, const Action &a) const noexcept {
 void Leduc::update_ranks() {
     for (int i = 0; i < m_n_players; i++) {
         Player &p = m_players[i];
-        if (m_round == Round::PREFLOP) {
+        if (m_round == LeducRound::PREFLOP) {
             std::string rank_str = "";
             Card* card = p.get_cards()[0];
             p.set_rank_str(std::string(*card)); 
@@ -231,19 +247,19 @@ void Leduc::reset_player_states() {
 }
 
 void Leduc::next_round() {
-    if (m_round == Round::REVEAL)
+    if (m_round == LeducRound::REVEAL)
         return;
     int i = static_cast<int>(m_round);
-    m_round = static_cast<Round>((i + 1) % (static_cast<int>(Round::REVEAL) + 1));
+    m_round = static_cast<LeducRound>((i + 1) % (static_cast<int>(LeducRound::REVEAL) + 1));
 }
 
 std::string Leduc::round_to_str() const noexcept {
     switch (m_round) {
-    case Round::PREFLOP:
+    case LeducRound::PREFLOP:
         return std::string("P.");
-    case Round::FLOP:
+    case LeducRound::FLOP:
         return std::string("F.");
-    case Round::REVEAL:
+    case LeducRound::REVEAL:
         return std::string("E.");
     default:
         return std::string("?.");
@@ -336,10 +352,26 @@ std::vector<Action> Leduc::get_valid_actions(int player){
     return valid;
 }
 
+Action Leduc::sample_action(const std::array<float, N_ACTIONS>& strategy, const std::array<uint8_t, N_ACTIONS>& valid, uint8_t){
+    std::uniform_real_distribution<double> unif(0, 1);
+    std::mt19937& gen = thread_rng();
+    std::array<float, N_ACTIONS> s;
+
+    if (unif(gen) > EPSILON){
+        s = strategy;
+    } else {
+        for (int i = 0; i < N_ACTIONS; i++){
+            s[i] = static_cast<float>(valid[i]);
+        }
+    }
+    std::discrete_distribution<> d(s.begin(), s.end());
+    int a = d(gen);
+    return m_actions[a];
+}
+
 /* TODO strategy as reference or not? */
 Action Leduc::sample_action(std::array<float, N_ACTIONS> strategy, uint8_t player){
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937& gen = thread_rng();
     std::discrete_distribution<> d(strategy.begin(), strategy.end());
     int a = d(gen);
     return m_actions[a];
@@ -351,7 +383,7 @@ std::string Leduc::create_key(uint8_t player)
     key.append(get_player_cards_str(player));
     key.append(m_players[player].get_history_without_current_round());
     key.append(m_history);
-    return pad_string(key, KEY_LENGTH);
+    return pad_key(key);
 }
 
 int Leduc::count_remaining_players() noexcept{
@@ -18,26 +18,52 @@
 #include <iostream>
 #include <vector>
 
+#include "options.h"
+#include "pipeline.h"
+#include "topology.h"
 #include "train.h"
 
 using namespace std;
 
 /* Use this for training */
-int main(){
-    unsigned int processor_count = thread::hardware_concurrency();
-    if (processor_count == 0) {
-        cout << "Could not detect number of processors. Using 1 thread.\n";
-        processor_count = 1;
-    } else {
-        cout << "Detected " << processor_count << " processors. ";
-        processor_count -= 1;
-        cout << "Using " << processor_count << " processors for training, 1 for monitoring.\n";
+int main(int argc, char** argv){
+    parse_options(argc, argv);
+    init_tree();
+
+    /* Respect affinity mask and cgroup quota, keep one CPU for monitoring if there is more than one */
+    CpuBudget budget = detect_cpu_budget();
+    print_cpu_budget(budget);
+    /* Dealers only run for Holdem, Leduc deals are trivial */
+    int n_dealers = g_options.game == GameType::HOLDEM ? g_options.n_dealers : 0;
+    if (n_dealers > 0 && g_options.n_partitions > 0) {
+        cout << "Partitioned sampling deals on training threads, ignoring --dealers.\n";
+        n_dealers = 0;
+    }
+    if (g_options.dealing != Dealing::RANDOM && g_options.n_partitions > 0) {
+        cout << "Partitioned sampling picks hero's cards, ignoring --dealing.\n";
+        g_options.dealing = Dealing::RANDOM;
+    }
+    if (n_dealers > 0 && g_options.dealing != Dealing::RANDOM) {
+        cout << "Stratified and importance dealing deal on training threads, ignoring --dealers.\n";
+        n_dealers = 0;
     }
+    g_options.n_dealers = n_dealers;
+    int spare = static_cast<int>(budget.available) - 1 - n_dealers;
+    unsigned int processor_count = spare > 1 ? spare : 1;
+    if (g_options.n_threads > 0) {
+        processor_count = g_options.n_threads;
+    }
+    cout << "Using " << processor_count << " threads for training, " << n_dealers << " for dealing, 1 for monitoring.\n";
+    init_workers(processor_count, processor_count);
+    init_pipeline(processor_count, n_dealers);
 
     vector<thread> threads;
 
     for (int i = 0; i < processor_count; i++) {
-        threads.push_back(thread(train));
+        threads.push_back(thread(train, i));
+    }
+    for (int i = 0; i < n_dealers; i++) {
+        threads.push_back(thread(dealer, i));
     }
     threads.push_back(thread(monitor));
 
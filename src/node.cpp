@@ -15,6 +15,7 @@
  */
 
 #include "node.h"
+#include <algorithm>
 #include <cmath>
 #include <math.h>
 
@@ -23,9 +24,16 @@ Node::Node() noexcept {
         m_regret_sum[i] = 0.0;
         m_strategy[i] = 1 / N_ACTIONS_f;
         m_strategy_sum[i] = 0;
+#if VR_BASELINES
+        m_baseline[i] = 0;
+#endif
     }
     m_visits = 0;
     m_visits_2 = 0;
+    m_discount_period = 0;
+    m_stable_visits = 0;
+    m_frozen_until = 0;
+    m_epoch = 0;
 }
 
 std::array<float, N_ACTIONS> Node::get_strategy() const noexcept {
@@ -55,13 +63,64 @@ std::array<float, N_ACTIONS> Node::get_strategy() const noexcept {
     return strategy;
 }
 
-void Node::update_avg_strategy(const std::array<float, N_ACTIONS>& strategy) noexcept {
+void Node::update_avg_strategy(const std::array<float, N_ACTIONS>& strategy, float weight) noexcept {
 
     for (int i = 0; i < N_ACTIONS; i++) {
-        m_strategy_sum[i] += strategy[i];
+        m_strategy_sum[i] = add_counter(m_strategy_sum[i], weight * strategy[i]);
     }
 }
 
+void Node::floor_regrets() noexcept {
+    for (int i = 0; i < N_ACTIONS; i++) {
+        if (m_regret_sum[i] < 0) m_regret_sum[i] = 0;
+    }
+}
+
+void Node::discount(float positive, float negative, float strategy) noexcept {
+    /* Atomic loads and stores, so discounting can run along relaxed updates - an update that comes in between
+       is lost, which only adds to the noise of sampling */
+    for (int i = 0; i < N_ACTIONS; i++) {
+        std::atomic_ref<Counter> regret(m_regret_sum[i]);
+        Counter r = regret.load(std::memory_order_relaxed);
+        regret.store(add_counter(0, r * (r > 0 ? positive : negative)), std::memory_order_relaxed);
+        std::atomic_ref<Counter> strategy_sum(m_strategy_sum[i]);
+        Counter s = strategy_sum.load(std::memory_order_relaxed);
+        strategy_sum.store(add_counter(0, s * strategy), std::memory_order_relaxed);
+    }
+}
+
+#if PURE_CFR
+int Node::sample_pure(uint64_t random) const noexcept {
+    int64_t total = 0;
+    int n_valid = 0;
+    for (int i = 0; i < N_ACTIONS; i++) {
+        if (m_valid_action_mask[i] == 0) continue;
+        n_valid++;
+        if (m_regret_sum[i] > 0) total += m_regret_sum[i];
+    }
+
+    /* No positive regret - uniform over valid actions */
+    if (total == 0) {
+        int target = static_cast<int>(random % static_cast<uint64_t>(std::max(n_valid, 1)));
+        for (int i = 0; i < N_ACTIONS; i++) {
+            if (m_valid_action_mask[i] != 0 && target-- == 0) return i;
+        }
+        return 0;
+    }
+
+    /* Total fits in 35 bits, bias of modulo of 64-bit number is negligible */
+    int64_t target = static_cast<int64_t>(random % static_cast<uint64_t>(total));
+    int last = 0;
+    for (int i = 0; i < N_ACTIONS; i++) {
+        if (m_valid_action_mask[i] == 0 || m_regret_sum[i] <= 0) continue;
+        target -= m_regret_sum[i];
+        last = i;
+        if (target < 0) return i;
+    }
+    return last;
+}
+#endif
+
 std::array<float, N_ACTIONS> Node::get_average_strategy() const noexcept {
     float sum = 0.0;
 
@@ -78,4 +137,86 @@ std::array<float, N_ACTIONS> Node::get_average_strategy() const noexcept {
             strategy[i] = 1 / N_ACTIONS_f;
     }
     return strategy;
-}
\ No newline at end of file
+}
+
+Node Node::load_relaxed() const noexcept {
+    /* atomic_ref needs non-const object, values are only loaded */
+    Node& self = const_cast<Node&>(*this);
+    Node node = Node();
+    for (int i = 0; i < N_ACTIONS; i++) {
+        node.m_regret_sum[i] = std::atomic_ref<Counter>(self.m_regret_sum[i]).load(std::memory_order_relaxed);
+        node.m_strategy_sum[i] = std::atomic_ref<Counter>(self.m_strategy_sum[i]).load(std::memory_order_relaxed);
+#if VR_BASELINES
+        node.m_baseline[i] = std::atomic_ref<float>(self.m_baseline[i]).load(std::memory_order_relaxed);
+#endif
+    }
+    node.m_visits = std::atomic_ref<int>(self.m_visits).load(std::memory_order_relaxed);
+    node.m_visits_2 = std::atomic_ref<int>(self.m_visits_2).load(std::memory_order_relaxed);
+    node.m_discount_period = std::atomic_ref<uint32_t>(self.m_discount_period).load(std::memory_order_relaxed);
+    for (int i = 0; i < N_ACTIONS; i++) {
+        node.m_strategy[i] = std::atomic_ref<float>(self.m_strategy[i]).load(std::memory_order_relaxed);
+    }
+    node.m_stable_visits = std::atomic_ref<uint32_t>(self.m_stable_visits).load(std::memory_order_relaxed);
+    node.m_frozen_until = std::atomic_ref<uint32_t>(self.m_frozen_until).load(std::memory_order_relaxed);
+    node.m_epoch = get_epoch();
+    /* Mask is written only once, before the node is published by unlocking the tree */
+    node.m_valid_action_mask = m_valid_action_mask;
+    return node;
+}
+
+void Node::update_avg_strategy_atomic(const std::array<float, N_ACTIONS>& strategy, float weight) noexcept {
+    for (int i = 0; i < N_ACTIONS; i++) {
+        if (strategy[i] == 0) continue;
+        add_atomic(m_strategy_sum[i], weight * strategy[i]);
+    }
+}
+
+uint32_t Node::claim_discount(uint32_t period) noexcept {
+    std::atomic_ref<uint32_t> current(m_discount_period);
+    uint32_t last = current.load(std::memory_order_relaxed);
+    while (last < period) {
+        if (current.compare_exchange_weak(last, period, std::memory_order_relaxed)) return last;
+    }
+    return period;
+}
+
+void Node::update_regret_sum_plus_atomic(int idx, float f) noexcept {
+    if (m_valid_action_mask[idx] == 0) return;
+    std::atomic_ref<Counter> regret(m_regret_sum[idx]);
+    Counter old = regret.load(std::memory_order_relaxed);
+    while (!regret.compare_exchange_weak(old, std::max(add_counter(old, f), Counter(0)), std::memory_order_relaxed)) {}
+}
+#if VR_BASELINES
+void Node::update_baseline_atomic(int idx, float value, float decay) noexcept {
+    /* Concurrent update may be lost, baseline only has to stay close to the mean */
+    std::atomic_ref<float> baseline(m_baseline[idx]);
+    float old = baseline.load(std::memory_order_relaxed);
+    baseline.store(old + decay * (value - old), std::memory_order_relaxed);
+}
+#endif
+
+bool Node::track_stability(const std::array<float, N_ACTIONS>& strategy, float tolerance, uint32_t window,
+                           uint32_t frozen_until) noexcept {
+    bool moved = false;
+    for (int i = 0; i < N_ACTIONS; i++) {
+        float start = std::atomic_ref<float>(m_strategy[i]).load(std::memory_order_relaxed);
+        if (std::fabs(strategy[i] - start) > tolerance) moved = true;
+    }
+
+    std::atomic_ref<uint32_t> stable(m_stable_visits);
+    if (moved) {
+        /* New window starts from the current strategy */
+        for (int i = 0; i < N_ACTIONS; i++) {
+            std::atomic_ref<float>(m_strategy[i]).store(strategy[i], std::memory_order_relaxed);
+        }
+        stable.store(0, std::memory_order_relaxed);
+        return false;
+    }
+    if (stable.load(std::memory_order_relaxed) + 1 < window) {
+        stable.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    stable.store(0, std::memory_order_relaxed);
+    std::atomic_ref<uint32_t>(m_frozen_until).store(frozen_until, std::memory_order_relaxed);
+    return true;
+}
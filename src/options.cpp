@@ -0,0 +1,256 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "options.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+Options g_options;
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --expected-nodes N    pre-size game tree for N nodes\n"
+              << "  --presize-from FILE   pre-size game tree for number of nodes in saved model FILE\n"
+              << "  --resume FILE         continue training from checkpoint FILE (tree), its deltas and FILE.state,\n"
+              << "                        FILE.trie is loaded instead of FILE with --layout trie\n"
+              << "  --huge-pages MODE     back game tree by huge pages: none, transparent or explicit\n"
+              << "  --prefault            fault game tree memory in when it is mapped\n"
+              << "  --pin                 pin training threads to cores\n"
+              << "  --numa MODE           placement of game tree: none, interleave or partition\n"
+              << "  --threads N           number of training threads, default is CPUs available to the process\n"
+              << "  --workers-file FILE   file with number of active training threads, can be changed at runtime\n"
+              << "  --game GAME           game to train: holdem or leduc\n"
+              << "  --update-mode MODE    node updates: locked or relaxed (atomic adds without lock)\n"
+              << "  --interleave N        number of traversals interleaved on each training thread\n"
+              << "  --dealers N           number of threads preparing deals for training threads (Holdem only)\n"
+              << "  --partitions N        training threads sample hero's cards from N rotating partitions (Holdem only)\n"
+              << "  --hot-tier            keep preflop nodes in dense array with per-node locks (Holdem only)\n"
+              << "  --layout LAYOUT       storage of game tree nodes: hash, public (grouped by public state) or trie\n"
+              << "  --variant VARIANT     update rule: vanilla, plus (CFR+), linear or dcfr\n"
+              << "  --dcfr A,B,G          DCFR exponents for positive regrets, negative regrets and strategy\n"
+              << "  --discount-every N    iterations between DCFR discounts\n"
+              << "  --prune-threshold X   hero actions with regret below X are pruned\n"
+              << "  --prune-after N       do not prune in the first N iterations\n"
+              << "  --explore-every N     every N-th iteration explores pruned actions too, 0 never does\n"
+              << "  --sampling MODE       traversal: external, outcome or public (chance sampling, Holdem only)\n"
+              << "  --os-epsilon X        exploration of hero's actions in outcome sampling\n"
+              << "  --dealing MODE        chance sampling: random, stratified (low-discrepancy) or importance\n"
+              << "  --importance-mix X    share of natural probability in importance sampling of hero's cards\n"
+              << "  --target-expl X       report iterations needed to reach Leduc exploitability X\n"
+              << "  --hero-sampling MODE  hero actions in external sampling: all or average\n"
+              << "  --as E,T,B            epsilon, threshold and bonus of average strategy sampling\n"
+              << "  --freeze X            freeze nodes whose strategy moved less than X over a window of visits\n"
+              << "  --freeze-window N     visits in the window\n"
+              << "  --freeze-recheck N    iterations after which frozen node is updated and checked again\n"
+              << "  --baselines           correct sampled values by learned baselines (VR-MCCFR)\n"
+              << "  --baseline-decay X    weight of new sample in baseline average\n"
+              << "  --help                print this message\n";
+}
+
+static const char* next_arg(int argc, char** argv, int& i) {
+    if (i + 1 >= argc) {
+        std::cout << "Missing value for " << argv[i] << ".\n";
+        print_usage(argv[0]);
+        std::exit(1);
+    }
+    return argv[++i];
+}
+
+void parse_options(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--expected-nodes") == 0) {
+            g_options.expected_nodes = std::strtoull(next_arg(argc, argv, i), nullptr, 10);
+        } else if (std::strcmp(argv[i], "--presize-from") == 0) {
+            g_options.presize_from = next_arg(argc, argv, i);
+        } else if (std::strcmp(argv[i], "--resume") == 0) {
+            g_options.resume_from = next_arg(argc, argv, i);
+        } else if (std::strcmp(argv[i], "--huge-pages") == 0) {
+            std::string mode = next_arg(argc, argv, i);
+            if (mode == "none") {
+                g_options.huge_pages = HugePages::NONE;
+            } else if (mode == "transparent") {
+                g_options.huge_pages = HugePages::TRANSPARENT;
+            } else if (mode == "explicit") {
+                g_options.huge_pages = HugePages::EXPLICIT;
+            } else {
+                std::cout << "Unknown huge pages mode " << mode << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--prefault") == 0) {
+            g_options.prefault = true;
+        } else if (std::strcmp(argv[i], "--pin") == 0) {
+            g_options.pin_threads = true;
+        } else if (std::strcmp(argv[i], "--numa") == 0) {
+            std::string mode = next_arg(argc, argv, i);
+            if (mode == "none") {
+                g_options.numa_mode = NumaMode::NONE;
+            } else if (mode == "interleave") {
+                g_options.numa_mode = NumaMode::INTERLEAVE;
+            } else if (mode == "partition") {
+                g_options.numa_mode = NumaMode::PARTITION;
+            } else {
+                std::cout << "Unknown NUMA mode " << mode << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            g_options.n_threads = std::strtoul(next_arg(argc, argv, i), nullptr, 10);
+        } else if (std::strcmp(argv[i], "--workers-file") == 0) {
+            g_options.workers_file = next_arg(argc, argv, i);
+        } else if (std::strcmp(argv[i], "--game") == 0) {
+            std::string game = next_arg(argc, argv, i);
+            if (game == "holdem") {
+                g_options.game = GameType::HOLDEM;
+            } else if (game == "leduc") {
+                g_options.game = GameType::LEDUC;
+            } else {
+                std::cout << "Unknown game " << game << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--update-mode") == 0) {
+            std::string mode = next_arg(argc, argv, i);
+            if (mode == "locked") {
+                g_options.update_mode = UpdateMode::LOCKED;
+            } else if (mode == "relaxed") {
+                g_options.update_mode = UpdateMode::RELAXED;
+            } else {
+                std::cout << "Unknown update mode " << mode << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--interleave") == 0) {
+            g_options.interleave = std::atoi(next_arg(argc, argv, i));
+        } else if (std::strcmp(argv[i], "--dealers") == 0) {
+            g_options.n_dealers = std::max(0, std::atoi(next_arg(argc, argv, i)));
+        } else if (std::strcmp(argv[i], "--partitions") == 0) {
+            g_options.n_partitions = std::max(0, std::atoi(next_arg(argc, argv, i)));
+        } else if (std::strcmp(argv[i], "--hot-tier") == 0) {
+            g_options.hot_tier = true;
+        } else if (std::strcmp(argv[i], "--layout") == 0) {
+            std::string layout = next_arg(argc, argv, i);
+            if (layout == "hash") {
+                g_options.layout = Layout::HASH;
+            } else if (layout == "public") {
+                g_options.layout = Layout::PUBLIC;
+            } else if (layout == "trie") {
+                g_options.layout = Layout::TRIE;
+            } else {
+                std::cout << "Unknown layout " << layout << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--variant") == 0) {
+            std::string variant = next_arg(argc, argv, i);
+            if (variant == "vanilla") {
+                g_options.variant = Variant::VANILLA;
+            } else if (variant == "plus") {
+                g_options.variant = Variant::PLUS;
+            } else if (variant == "linear") {
+                g_options.variant = Variant::LINEAR;
+            } else if (variant == "dcfr") {
+                g_options.variant = Variant::DCFR;
+            } else {
+                std::cout << "Unknown variant " << variant << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--dcfr") == 0) {
+            const char* exponents = next_arg(argc, argv, i);
+            if (std::sscanf(exponents, "%f,%f,%f", &g_options.dcfr_alpha, &g_options.dcfr_beta,
+                            &g_options.dcfr_gamma) != 3) {
+                std::cout << "DCFR exponents have to be given as ALPHA,BETA,GAMMA.\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--discount-every") == 0) {
+            g_options.discount_every = std::max(1, std::atoi(next_arg(argc, argv, i)));
+        } else if (std::strcmp(argv[i], "--prune-threshold") == 0) {
+            g_options.prune_threshold = std::atof(next_arg(argc, argv, i));
+        } else if (std::strcmp(argv[i], "--prune-after") == 0) {
+            g_options.prune_after = std::strtoul(next_arg(argc, argv, i), nullptr, 10);
+        } else if (std::strcmp(argv[i], "--explore-every") == 0) {
+            g_options.explore_every = std::strtoul(next_arg(argc, argv, i), nullptr, 10);
+        } else if (std::strcmp(argv[i], "--sampling") == 0) {
+            std::string sampling = next_arg(argc, argv, i);
+            if (sampling == "external") {
+                g_options.sampling = Sampling::EXTERNAL;
+            } else if (sampling == "outcome") {
+                g_options.sampling = Sampling::OUTCOME;
+            } else if (sampling == "public") {
+                g_options.sampling = Sampling::PUBLIC;
+            } else {
+                std::cout << "Unknown sampling " << sampling << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--os-epsilon") == 0) {
+            g_options.os_epsilon = std::clamp(static_cast<float>(std::atof(next_arg(argc, argv, i))), 0.0f, 1.0f);
+        } else if (std::strcmp(argv[i], "--dealing") == 0) {
+            std::string dealing = next_arg(argc, argv, i);
+            if (dealing == "random") {
+                g_options.dealing = Dealing::RANDOM;
+            } else if (dealing == "stratified") {
+                g_options.dealing = Dealing::STRATIFIED;
+            } else if (dealing == "importance") {
+                g_options.dealing = Dealing::IMPORTANCE;
+            } else {
+                std::cout << "Unknown dealing " << dealing << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--importance-mix") == 0) {
+            g_options.importance_mix = std::clamp(static_cast<float>(std::atof(next_arg(argc, argv, i))), 0.01f, 1.0f);
+        } else if (std::strcmp(argv[i], "--target-expl") == 0) {
+            g_options.target_exploitability = std::atof(next_arg(argc, argv, i));
+        } else if (std::strcmp(argv[i], "--hero-sampling") == 0) {
+            std::string sampling = next_arg(argc, argv, i);
+            if (sampling == "all") {
+                g_options.hero_sampling = HeroSampling::ALL;
+            } else if (sampling == "average") {
+                g_options.hero_sampling = HeroSampling::AVERAGE;
+            } else {
+                std::cout << "Unknown hero sampling " << sampling << ".\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--as") == 0) {
+            const char* parameters = next_arg(argc, argv, i);
+            if (std::sscanf(parameters, "%f,%f,%f", &g_options.as_epsilon, &g_options.as_tau,
+                            &g_options.as_beta) != 3) {
+                std::cout << "Average sampling parameters have to be given as EPSILON,TAU,BETA.\n";
+                std::exit(1);
+            }
+        } else if (std::strcmp(argv[i], "--freeze") == 0) {
+            g_options.freeze_tolerance = std::max(0.0f, static_cast<float>(std::atof(next_arg(argc, argv, i))));
+        } else if (std::strcmp(argv[i], "--freeze-window") == 0) {
+            g_options.freeze_window = std::max(1, std::atoi(next_arg(argc, argv, i)));
+        } else if (std::strcmp(argv[i], "--freeze-recheck") == 0) {
+            g_options.freeze_recheck = std::strtoul(next_arg(argc, argv, i), nullptr, 10);
+        } else if (std::strcmp(argv[i], "--baselines") == 0) {
+            if (!VR_BASELINES) {
+                std::cout << "Baselines are not available, build with VR_BASELINES set in settings.h.\n";
+                std::exit(1);
+            }
+            g_options.baselines = true;
+        } else if (std::strcmp(argv[i], "--baseline-decay") == 0) {
+            g_options.baseline_decay = std::clamp(static_cast<float>(std::atof(next_arg(argc, argv, i))), 0.0f, 1.0f);
+        } else if (std::strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            std::exit(0);
+        } else {
+            std::cout << "Unknown option " << argv[i] << ".\n";
+            print_usage(argv[0]);
+            std::exit(1);
+        }
+    }
+}
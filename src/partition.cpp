@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "partition.h"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "rng.h"
+#include "settings.h"
+
+const std::vector<std::array<uint8_t, 2>>& hole_combos() {
+    static const std::vector<std::array<uint8_t, 2>> combos = [] {
+        std::vector<std::array<uint8_t, 2>> c;
+        for (uint8_t i = 0; i < 52; i++) {
+            for (uint8_t j = i + 1; j < 52; j++) {
+                c.push_back({j, i});
+            }
+        }
+        /* Card code is value * 4 + suit */
+        auto klass = [](const std::array<uint8_t, 2>& h) {
+            return std::make_tuple(-(h[0] >> 2), -(h[1] >> 2), (h[0] & 3) != (h[1] & 3));
+        };
+        std::stable_sort(c.begin(), c.end(), [&](const auto& a, const auto& b) { return klass(a) < klass(b); });
+        return c;
+    }();
+    return combos;
+}
+
+HandPartition::HandPartition(int n_partitions, int first)
+    : m_n_partitions(std::clamp(n_partitions, 1, N_HOLE_COMBOS))
+    , m_rng(stream_seed()) {
+    set_partition(first % m_n_partitions);
+}
+
+void HandPartition::set_partition(int partition) noexcept {
+    m_current = partition;
+    m_begin = N_HOLE_COMBOS * partition / m_n_partitions;
+    m_end = N_HOLE_COMBOS * (partition + 1) / m_n_partitions;
+    m_games_left = static_cast<long int>(m_end - m_begin) * PARTITION_ROTATION;
+}
+
+std::array<uint8_t, 2> HandPartition::sample() {
+    if (m_games_left-- == 0) {
+        set_partition((m_current + 1) % m_n_partitions);
+        m_games_left--;
+    }
+    std::uniform_int_distribution<int> dist(m_begin, m_end - 1);
+    return hole_combos()[dist(m_rng)];
+}
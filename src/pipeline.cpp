@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "pipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "game.h"
+#include "queue.h"
+#include "rng.h"
+#include "settings.h"
+
+using namespace std;
+
+typedef SpscQueue<Deal, DEAL_QUEUE_SIZE> DealQueue;
+
+static vector<unique_ptr<DealQueue>> g_queues;
+static int g_n_dealers = 0;
+static atomic<bool> g_dealing(false);
+static atomic<uint64_t> g_deal_misses(0);
+
+void init_pipeline(int n_workers, int n_dealers) {
+    g_n_dealers = n_dealers;
+    g_queues.clear();
+    if (n_dealers <= 0) return;
+    for (int i = 0; i < n_workers; i++) {
+        g_queues.push_back(make_unique<DealQueue>());
+    }
+    g_dealing = true;
+}
+
+void stop_pipeline() { g_dealing = false; }
+
+void dealer(int idx) {
+    /* Streams of training threads go first */
+    set_thread_stream(g_queues.size() + 1 + idx);
+    Holdem game(N_PLAYERS, BIG_BLIND, SMALL_BLIND, MAX_RERAISES);
+    Deal deal;
+    bool prepared = false;
+
+    while (g_dealing) {
+        bool pushed = false;
+        for (size_t w = idx; w < g_queues.size(); w += g_n_dealers) {
+            if (g_queues[w]->full()) continue;
+            if (!prepared) game.prepare_deal(deal);
+            prepared = !g_queues[w]->push(std::move(deal));
+            pushed = true;
+        }
+        /* All served queues are full, training threads are slower than dealing */
+        if (!pushed) this_thread::sleep_for(chrono::microseconds(100));
+    }
+}
+
+bool take_deal(int worker, Deal& deal) {
+    if (g_n_dealers <= 0) return false;
+    if (g_queues[worker]->pop(deal)) return true;
+    g_deal_misses.fetch_add(1, memory_order_relaxed);
+    return false;
+}
+
+uint64_t get_deal_misses() { return g_deal_misses.load(memory_order_relaxed); }
@@ -0,0 +1,212 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "public_table.h"
+
+#include <algorithm>
+#include <cstring>
+
+PublicTable::PublicTable()
+    : m_buckets(TABLE_MIN_BUCKETS >> 6, Arena<PublicState>::NONE)
+    , m_mask((TABLE_MIN_BUCKETS >> 6) - 1)
+    , m_size(0)
+    , m_index_bytes(0) {}
+
+PublicTable::~PublicTable() {
+    for (uint32_t b : m_buckets) {
+        for (uint32_t i = b; i != Arena<PublicState>::NONE; i = m_states.at(i).next) {
+            delete[] m_states.at(i).index;
+        }
+    }
+}
+
+void PublicTable::set_numa_mode(NumaMode mode, int n_numa_nodes) {
+    m_entries.set_numa_mode(mode, n_numa_nodes);
+}
+
+void PublicTable::split(const std::string& key, std::string_view& cards, std::string_view& public_part) noexcept {
+    size_t length = key.size();
+    size_t pos = key.find('-');
+    /* Whole key is public if it has no card part, too long card part continues in the public one */
+    if (pos >= length) pos = 0;
+    pos = std::min(pos, static_cast<size_t>(CARD_KEY_LENGTH));
+    cards = std::string_view(key.data(), pos);
+    public_part = std::string_view(key.data() + pos, length - pos);
+}
+
+uint64_t PublicTable::hash(std::string_view s) noexcept { return std::hash<std::string_view>{}(s); }
+
+uint64_t PublicTable::hash_key(const std::string& key) const noexcept {
+    std::string_view cards, public_part;
+    split(key, cards, public_part);
+    return hash(public_part);
+}
+
+uint32_t PublicTable::find_state(std::string_view public_part, uint64_t h) const noexcept {
+    for (uint32_t i = m_buckets[h & m_mask]; i != Arena<PublicState>::NONE; i = m_states.at(i).next) {
+        const PublicState& s = m_states.at(i);
+        if (s.hash == static_cast<uint32_t>(h) && std::string_view(s.key.data(), s.length) == public_part) return i;
+    }
+    return Arena<PublicState>::NONE;
+}
+
+uint32_t PublicTable::add_state(std::string_view public_part, uint64_t h) {
+    uint32_t i = m_states.allocate();
+    PublicState& s = m_states.at(i);
+    s.hash = static_cast<uint32_t>(h);
+    s.length = static_cast<uint8_t>(public_part.size());
+    std::memcpy(s.key.data(), public_part.data(), s.length);
+    s.index_mask = 15;
+    s.index = new uint32_t[s.index_mask + 1]();
+    m_index_bytes += (s.index_mask + 1) * sizeof(uint32_t);
+    s.n_entries = 0;
+    s.run_next = s.run_end = s.run_spare = Arena<Entry>::NONE;
+
+    s.next = m_buckets[h & m_mask];
+    m_buckets[h & m_mask] = i;
+
+    if (m_states.size() > m_buckets.size()) {
+        /* Rebuild bucket array twice as large */
+        std::vector<uint32_t> buckets(2 * m_buckets.size(), Arena<PublicState>::NONE);
+        size_t mask = buckets.size() - 1;
+        for (uint32_t b : m_buckets) {
+            for (uint32_t j = b; j != Arena<PublicState>::NONE;) {
+                PublicState& moved = m_states.at(j);
+                uint32_t next = moved.next;
+                moved.next = buckets[moved.hash & mask];
+                buckets[moved.hash & mask] = j;
+                j = next;
+            }
+        }
+        m_buckets.swap(buckets);
+        m_mask = mask;
+    }
+    return i;
+}
+
+uint32_t* PublicTable::find_slot(const PublicState& state, std::string_view cards, uint32_t h) const noexcept {
+    for (uint32_t slot = h & state.index_mask;; slot = (slot + 1) & state.index_mask) {
+        uint32_t i = state.index[slot];
+        if (i == Arena<Entry>::NONE) return &state.index[slot];
+        const Entry& e = m_entries.at(i);
+        if (e.hash == h && std::string_view(e.cards.data(), e.length) == cards) return &state.index[slot];
+    }
+}
+
+void PublicTable::grow_index(PublicState& state) {
+    uint32_t old_mask = state.index_mask;
+    uint32_t* old = state.index;
+    state.index_mask = 2 * (old_mask + 1) - 1;
+    state.index = new uint32_t[state.index_mask + 1]();
+    for (uint32_t slot = 0; slot <= old_mask; slot++) {
+        if (old[slot] == Arena<Entry>::NONE) continue;
+        uint32_t s = m_entries.at(old[slot]).hash & state.index_mask;
+        while (state.index[s] != Arena<Entry>::NONE) s = (s + 1) & state.index_mask;
+        state.index[s] = old[slot];
+    }
+    delete[] old;
+    m_index_bytes += (state.index_mask - old_mask) * sizeof(uint32_t);
+}
+
+uint32_t PublicTable::allocate_entry(PublicState& state) {
+    /* Run is taken from the arena in one go, so it is contiguous unless it crosses arena chunk. Record past
+       the break is kept for the next run. Run is as long as the state has nodes, so it doubles their number. */
+    if (state.run_next == state.run_end) {
+        if (state.run_spare != Arena<Entry>::NONE) {
+            state.run_next = state.run_spare;
+            state.run_spare = Arena<Entry>::NONE;
+        } else {
+            state.run_next = m_entries.allocate(current_numa_node());
+        }
+        state.run_end = state.run_next + 1;
+        uint32_t length = std::clamp<uint32_t>(state.n_entries, 1, PUBLIC_RUN);
+        for (uint32_t i = 1; i < length; i++) {
+            uint32_t idx = m_entries.allocate(current_numa_node());
+            if (idx != state.run_end) {
+                state.run_spare = idx;
+                break;
+            }
+            state.run_end++;
+        }
+    }
+    return state.run_next++;
+}
+
+Node& PublicTable::get(const std::string& key, uint64_t h, bool& inserted) {
+    std::string_view cards, public_part;
+    split(key, cards, public_part);
+
+    uint32_t s = find_state(public_part, h);
+    if (s == Arena<PublicState>::NONE) s = add_state(public_part, h);
+    PublicState& state = m_states.at(s);
+
+    uint32_t card_hash = static_cast<uint32_t>(hash(cards));
+    uint32_t* slot = find_slot(state, cards, card_hash);
+    if (*slot != Arena<Entry>::NONE) {
+        inserted = false;
+        return m_entries.at(*slot).node;
+    }
+
+    uint32_t i = allocate_entry(state);
+    Entry& e = m_entries.at(i);
+    e.hash = card_hash;
+    e.length = static_cast<uint8_t>(cards.size());
+    std::memcpy(e.cards.data(), cards.data(), e.length);
+    *slot = i;
+    state.n_entries++;
+    m_size++;
+    inserted = true;
+
+    /* Keep index at most half full */
+    if (2 * state.n_entries > state.index_mask + 1) grow_index(state);
+    return e.node;
+}
+
+const Node* PublicTable::find(const std::string& key) const noexcept {
+    std::string_view cards, public_part;
+    split(key, cards, public_part);
+    uint32_t s = find_state(public_part, hash(public_part));
+    if (s == Arena<PublicState>::NONE) return nullptr;
+    uint32_t* slot = find_slot(m_states.at(s), cards, static_cast<uint32_t>(hash(cards)));
+    return *slot == Arena<Entry>::NONE ? nullptr : &m_entries.at(*slot).node;
+}
+
+void PublicTable::for_each(const std::function<void(const std::string&, Node&)>& f) const {
+    for (uint32_t b : m_buckets) {
+        for (uint32_t i = b; i != Arena<PublicState>::NONE; i = m_states.at(i).next) {
+            const PublicState& state = m_states.at(i);
+            std::string public_part(state.key.data(), state.length);
+            for (uint32_t slot = 0; slot <= state.index_mask; slot++) {
+                if (state.index[slot] == Arena<Entry>::NONE) continue;
+                Entry& e = m_entries.at(state.index[slot]);
+                f(std::string(e.cards.data(), e.length) + public_part, e.node);
+            }
+        }
+    }
+}
+
+void PublicTable::reserve(size_t n_nodes) { m_entries.reserve(n_nodes); }
+
+size_t PublicTable::bytes_used() const noexcept {
+    return m_entries.bytes_mapped() + m_states.bytes_mapped() + m_buckets.size() * sizeof(uint32_t) + m_index_bytes;
+}
+
+size_t PublicTable::bytes_per_node() const noexcept {
+    if (m_size == 0) return 0;
+    size_t bytes = m_entries.size() * sizeof(Entry) + m_states.size() * sizeof(PublicState) +
+                   m_buckets.size() * sizeof(uint32_t) + m_index_bytes;
+    return bytes / m_size;
+}
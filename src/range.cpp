@@ -0,0 +1,125 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "range.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+Range::Range() {
+    for (int i = 0; i < 52; i++) m_cards[i] = Card(i);
+}
+
+void Range::init(const Holdem& game) {
+    std::array<bool, 52> blocked{};
+    for (Card* c : game.get_flop()) blocked[c->get_code()] = true;
+    blocked[game.get_turn()->get_code()] = true;
+
+    std::vector<std::pair<Hand, std::array<std::string, N_ROUNDS>>> evaluated;
+    for (uint8_t i = 0; i < 52; i++) {
+        if (blocked[i]) continue;
+        for (uint8_t j = i + 1; j < 52; j++) {
+            if (blocked[j]) continue;
+            evaluated.emplace_back();
+            Hand& hand = evaluated.back().first;
+            hand.cards = {j, i};
+            game.evaluate_hole({&m_cards[j], &m_cards[i]}, evaluated.back().second, hand.rank);
+        }
+    }
+
+    /* Hands are kept from the weakest to the strongest, higher rank value is weaker hand */
+    std::stable_sort(evaluated.begin(), evaluated.end(),
+                     [](const auto& a, const auto& b) { return a.first.rank > b.first.rank; });
+
+    m_hands.clear();
+    std::array<std::unordered_map<std::string, int>, N_ROUNDS> bucket_idx;
+    for (int r = 0; r < N_ROUNDS; r++) {
+        m_buckets[r].clear();
+        m_bucket_str[r].clear();
+    }
+    for (const auto& [hand, rank_str] : evaluated) {
+        m_hands.push_back(hand);
+        for (int r = 0; r < N_ROUNDS; r++) {
+            auto inserted = bucket_idx[r].emplace(rank_str[r], static_cast<int>(m_bucket_str[r].size()));
+            if (inserted.second) m_bucket_str[r].push_back(rank_str[r]);
+            m_buckets[r].push_back(inserted.first->second);
+        }
+    }
+}
+
+void Range::fold_values(const std::vector<float>& opp_reach, float payoff, std::vector<float>& values) const {
+    /* Reach of hands holding each card, hands holding both cards of hero's hand are the hero's hand itself */
+    float total = 0;
+    std::array<float, 52> card_reach{};
+    for (size_t i = 0; i < m_hands.size(); i++) {
+        total += opp_reach[i];
+        card_reach[m_hands[i].cards[0]] += opp_reach[i];
+        card_reach[m_hands[i].cards[1]] += opp_reach[i];
+    }
+    for (size_t i = 0; i < m_hands.size(); i++) {
+        const Hand& h = m_hands[i];
+        values[i] = payoff * (total - card_reach[h.cards[0]] - card_reach[h.cards[1]] + opp_reach[i]);
+    }
+}
+
+void Range::showdown_values(const std::vector<float>& opp_reach, float win, float lose, float tie,
+                            std::vector<float>& values) const {
+    size_t n = m_hands.size();
+    std::vector<float> weaker(n), stronger(n);
+
+    /* Sweep from the weakest hand, reach of strictly weaker hands is collected before a group of equal ranks
+       is added */
+    float total = 0;
+    std::array<float, 52> card_reach{};
+    for (size_t begin = 0; begin < n;) {
+        size_t end = begin;
+        while (end < n && m_hands[end].rank == m_hands[begin].rank) end++;
+        for (size_t i = begin; i < end; i++) {
+            weaker[i] = total - card_reach[m_hands[i].cards[0]] - card_reach[m_hands[i].cards[1]];
+        }
+        for (size_t i = begin; i < end; i++) {
+            total += opp_reach[i];
+            card_reach[m_hands[i].cards[0]] += opp_reach[i];
+            card_reach[m_hands[i].cards[1]] += opp_reach[i];
+        }
+        begin = end;
+    }
+
+    /* Same from the strongest hand */
+    total = 0;
+    card_reach.fill(0);
+    for (size_t end = n; end > 0;) {
+        size_t begin = end - 1;
+        while (begin > 0 && m_hands[begin - 1].rank == m_hands[end - 1].rank) begin--;
+        for (size_t i = begin; i < end; i++) {
+            stronger[i] = total - card_reach[m_hands[i].cards[0]] - card_reach[m_hands[i].cards[1]];
+        }
+        for (size_t i = begin; i < end; i++) {
+            total += opp_reach[i];
+            card_reach[m_hands[i].cards[0]] += opp_reach[i];
+            card_reach[m_hands[i].cards[1]] += opp_reach[i];
+        }
+        end = begin;
+    }
+
+    /* total now holds reach of all hands, the rest of compatible hands tie */
+    for (size_t i = 0; i < n; i++) {
+        const Hand& h = m_hands[i];
+        float compatible = total - card_reach[h.cards[0]] - card_reach[h.cards[1]] + opp_reach[i];
+        float tied = compatible - weaker[i] - stronger[i];
+        values[i] = win * weaker[i] + lose * stronger[i] + tie * tied;
+    }
+}
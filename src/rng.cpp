@@ -0,0 +1,52 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "rng.h"
+
+static uint64_t g_master_seed = std::random_device{}() | static_cast<uint64_t>(std::random_device{}()) << 32;
+static uint64_t g_generation = 0;
+
+static thread_local uint64_t t_stream = 0;
+static thread_local uint64_t t_n_seeds = 0;
+
+/* SplitMix64 finalizer, nearby inputs give unrelated outputs */
+static inline uint64_t mix(uint64_t x) noexcept {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+void set_master_seed(uint64_t seed, uint64_t generation) {
+    g_master_seed = seed;
+    g_generation = generation;
+}
+
+uint64_t get_master_seed() { return g_master_seed; }
+
+void set_thread_stream(uint64_t stream) {
+    t_stream = stream;
+    t_n_seeds = 0;
+}
+
+uint64_t stream_seed() {
+    return mix(mix(mix(g_master_seed) ^ g_generation) ^ t_stream) ^ mix(t_n_seeds++);
+}
+
+std::mt19937& thread_rng() {
+    static thread_local std::mt19937 rng(stream_seed());
+    return rng;
+}
@@ -0,0 +1,125 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "stratified.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+#include "partition.h"
+#include "rng.h"
+
+/* Generalized golden ratio for three dimensions, root of x^4 = x + 1. Its powers give the Kronecker sequence
+   with the most even coverage of the cube (Roberts' R3 sequence). */
+static constexpr double PHI_3 = 1.2207440846057596;
+static constexpr std::array<double, 3> ALPHA = {1 / PHI_3, 1 / (PHI_3 * PHI_3), 1 / (PHI_3 * PHI_3 * PHI_3)};
+
+/* All flops ordered by suit pattern (monotone, two-tone, rainbow) and ranks, so flops of one suit isomorphism
+   class are next to each other */
+static const std::vector<std::array<uint8_t, 3>>& flops() {
+    static const std::vector<std::array<uint8_t, 3>> all = [] {
+        std::vector<std::array<uint8_t, 3>> f;
+        for (uint8_t i = 0; i < 52; i++) {
+            for (uint8_t j = i + 1; j < 52; j++) {
+                for (uint8_t k = j + 1; k < 52; k++) {
+                    f.push_back({k, j, i});
+                }
+            }
+        }
+        /* Card code is value * 4 + suit, cards of a flop are in descending order */
+        auto klass = [](const std::array<uint8_t, 3>& c) {
+            int suits = 1 + ((c[0] & 3) != (c[1] & 3)) + ((c[2] & 3) != (c[0] & 3) && (c[2] & 3) != (c[1] & 3));
+            return std::make_tuple(suits, -(c[0] >> 2), -(c[1] >> 2), -(c[2] >> 2));
+        };
+        std::stable_sort(f.begin(), f.end(), [&](const auto& a, const auto& b) { return klass(a) < klass(b); });
+        return f;
+    }();
+    return all;
+}
+
+static inline size_t scale(double x, size_t n) noexcept {
+    return std::min(static_cast<size_t>(x * static_cast<double>(n)), n - 1);
+}
+
+StratifiedDealer::StratifiedDealer() : m_rng(stream_seed()) {
+    std::uniform_real_distribution<double> uniform(0, 1);
+    for (double& x : m_point) x = uniform(m_rng);
+}
+
+std::array<double, 3> StratifiedDealer::next_point() noexcept {
+    std::array<double, 3> point = m_point;
+    for (int d = 0; d < 3; d++) {
+        m_point[d] += ALPHA[d];
+        m_point[d] -= std::floor(m_point[d]);
+    }
+    return point;
+}
+
+std::array<uint8_t, N_DEAL_CARDS> StratifiedDealer::deal_holdem(int player) {
+    std::array<double, 3> x = next_point();
+    std::array<bool, 52> used{};
+
+    const std::array<uint8_t, 2>& hole = hole_combos()[scale(x[0], N_HOLE_COMBOS)];
+    used[hole[0]] = used[hole[1]] = true;
+
+    /* Flop blocked by hole cards is replaced by random compatible one. The point picks compatible flop with
+       probability 1/|all flops|, the replacement adds the same share of blocked ones to each compatible flop,
+       so given the hole cards, flop is still uniform. */
+    const std::vector<std::array<uint8_t, 3>>& all_flops = flops();
+    std::array<uint8_t, 3> flop = all_flops[scale(x[1], all_flops.size())];
+    std::uniform_int_distribution<size_t> flop_dist(0, all_flops.size() - 1);
+    while (used[flop[0]] || used[flop[1]] || used[flop[2]]) flop = all_flops[flop_dist(m_rng)];
+    for (uint8_t c : flop) used[c] = true;
+
+    std::vector<uint8_t> rest;
+    for (uint8_t c = 0; c < 52; c++) {
+        if (!used[c]) rest.push_back(c);
+    }
+    size_t turn_idx = scale(x[2], rest.size());
+    uint8_t turn = rest[turn_idx];
+    rest.erase(rest.begin() + turn_idx);
+    std::shuffle(rest.begin(), rest.end(), m_rng);
+
+    std::array<uint8_t, N_DEAL_CARDS> cards;
+    size_t next = 0;
+    for (int i = 0; i < N_PLAYERS; i++) {
+        if (i == player) {
+            cards[2 * i] = hole[0];
+            cards[2 * i + 1] = hole[1];
+        } else {
+            cards[2 * i] = rest[next++];
+            cards[2 * i + 1] = rest[next++];
+        }
+    }
+    for (int i = 0; i < 3; i++) cards[2 * N_PLAYERS + i] = flop[i];
+    cards[2 * N_PLAYERS + 3] = turn;
+    cards[2 * N_PLAYERS + 4] = rest[next];
+    return cards;
+}
+
+std::array<int, 3> StratifiedDealer::deal_leduc() {
+    std::array<double, 3> x = next_point();
+    std::vector<int> rest = {0, 1, 2, 3, 4, 5};
+    std::array<int, 3> deal;
+    for (int d = 0; d < 3; d++) {
+        size_t idx = scale(x[d], rest.size());
+        deal[d] = rest[idx];
+        rest.erase(rest.begin() + idx);
+    }
+    return deal;
+}
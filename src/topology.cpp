@@ -0,0 +1,226 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static thread_local int t_numa_node = 0;
+
+/* Parses cpulist format used by sysfs, e.g. "0-3,8-11" */
+static std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static bool read_affinity(cpu_set_t& set) {
+    CPU_ZERO(&set);
+    return sched_getaffinity(0, sizeof(cpu_set_t), &set) == 0;
+}
+
+/* Quota of cgroup v2 from cpu.max of the cgroup and its parents, the tightest one applies */
+static double read_cgroup_v2_quota() {
+    std::ifstream f_cgroup("/proc/self/cgroup");
+    std::string line, path;
+    while (std::getline(f_cgroup, line)) {
+        if (line.rfind("0::", 0) == 0) path = line.substr(3);
+    }
+    if (path.empty()) return 0;
+
+    double quota = 0;
+    while (true) {
+        std::ifstream f("/sys/fs/cgroup" + (path == "/" ? std::string("") : path) + "/cpu.max");
+        std::string max, period;
+        if (f >> max >> period && max != "max") {
+            double q = std::stod(max) / std::stod(period);
+            if (quota == 0 || q < quota) quota = q;
+        }
+        if (path == "/" || path.empty()) break;
+        size_t pos = path.find_last_of('/');
+        path = pos == 0 ? "/" : path.substr(0, pos);
+    }
+    return quota;
+}
+
+static double read_cgroup_v1_quota() {
+    for (std::string dir : {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct"}) {
+        std::ifstream f_quota(dir + "/cpu.cfs_quota_us");
+        std::ifstream f_period(dir + "/cpu.cfs_period_us");
+        long quota, period;
+        if (f_quota >> quota && f_period >> period && quota > 0 && period > 0) {
+            return static_cast<double>(quota) / period;
+        }
+    }
+    return 0;
+}
+
+CpuBudget detect_cpu_budget() {
+    CpuBudget budget;
+    budget.hardware = std::thread::hardware_concurrency();
+    if (budget.hardware == 0) budget.hardware = 1;
+
+    cpu_set_t set;
+    budget.affinity = read_affinity(set) ? CPU_COUNT(&set) : budget.hardware;
+
+    budget.quota = read_cgroup_v2_quota();
+    if (budget.quota == 0) budget.quota = read_cgroup_v1_quota();
+
+    budget.available = std::min(budget.hardware, budget.affinity);
+    if (budget.quota > 0) {
+        /* Partial CPU is rounded up, otherwise fractional quota like 0.5 would leave no thread at all */
+        budget.available = std::min(budget.available, static_cast<unsigned int>(std::ceil(budget.quota)));
+    }
+    budget.available = std::max(budget.available, 1u);
+    return budget;
+}
+
+void print_cpu_budget(const CpuBudget& budget) {
+    std::cout << "Detected " << budget.hardware << " processors, " << budget.affinity << " in affinity mask, ";
+    if (budget.quota > 0) {
+        std::cout << "cgroup quota " << budget.quota << " CPUs";
+    } else {
+        std::cout << "no cgroup quota";
+    }
+    std::cout << " -> " << budget.available << " available.\n";
+}
+
+static Topology detect_topology() {
+    Topology topology;
+    cpu_set_t set;
+    bool has_affinity = read_affinity(set);
+
+    for (int node = 0;; node++) {
+        std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!f.is_open()) break;
+        std::string list;
+        std::getline(f, list);
+        std::vector<int> cpus = parse_cpu_list(list);
+        if (has_affinity) {
+            std::erase_if(cpus, [&](int cpu) { return !CPU_ISSET(cpu, &set); });
+        }
+        topology.nodes.push_back(cpus);
+    }
+
+    if (topology.nodes.empty()) {
+        std::vector<int> cpus;
+        unsigned int n = std::thread::hardware_concurrency();
+        for (unsigned int cpu = 0; cpu < (n > 0 ? n : 1); cpu++) {
+            if (!has_affinity || CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+        topology.nodes.push_back(cpus);
+    }
+    return topology;
+}
+
+const Topology& get_topology() {
+    static const Topology topology = detect_topology();
+    return topology;
+}
+
+void print_topology(const Topology& topology) {
+    std::cout << "Detected " << topology.nodes.size() << " NUMA node" << (topology.nodes.size() > 1 ? "s" : "")
+              << ":";
+    for (size_t node = 0; node < topology.nodes.size(); node++) {
+        std::cout << " node" << node << " = {";
+        for (size_t i = 0; i < topology.nodes[node].size(); i++) {
+            std::cout << (i ? "," : "") << topology.nodes[node][i];
+        }
+        std::cout << "}";
+    }
+    std::cout << "\n";
+}
+
+int cpu_for_worker(const Topology& topology, int worker) {
+    /* Skip nodes without CPUs (memory only nodes) */
+    std::vector<const std::vector<int>*> nodes;
+    for (const std::vector<int>& cpus : topology.nodes) {
+        if (!cpus.empty()) nodes.push_back(&cpus);
+    }
+    if (nodes.empty()) return -1;
+
+    const std::vector<int>& cpus = *nodes[worker % nodes.size()];
+    return cpus[(worker / nodes.size()) % cpus.size()];
+}
+
+int numa_node_of_cpu(const Topology& topology, int cpu) {
+    for (size_t node = 0; node < topology.nodes.size(); node++) {
+        for (int c : topology.nodes[node]) {
+            if (c == cpu) return static_cast<int>(node);
+        }
+    }
+    return 0;
+}
+
+bool pin_thread(int cpu) {
+    if (cpu < 0) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0;
+}
+
+int current_numa_node() noexcept { return t_numa_node; }
+
+void set_current_numa_node(int node) noexcept { t_numa_node = node; }
+
+/* Raw syscalls, so libnuma is not needed to build */
+void set_local_memory_policy() noexcept {
+    syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0);
+}
+
+void place_region(void* ptr, size_t bytes, int numa_node) noexcept {
+    if (numa_node == NUMA_DEFAULT) return;
+
+    const Topology& topology = get_topology();
+    if (topology.nodes.size() < 2) return;
+
+    unsigned long mask = 0;
+    int mode = MPOL_PREFERRED;
+    if (numa_node == NUMA_INTERLEAVE) {
+        for (size_t node = 0; node < topology.nodes.size() && node < 8 * sizeof(mask); node++) mask |= 1ul << node;
+        mode = MPOL_INTERLEAVE;
+    } else {
+        mask = 1ul << numa_node;
+    }
+    if (syscall(SYS_mbind, ptr, bytes, mode, &mask, 8 * sizeof(mask), 0) != 0) {
+        static bool warned = false;
+        if (!warned) {
+            std::cout << "Could not set NUMA placement of game tree memory.\n";
+            warned = true;
+        }
+    }
+}
@@ -22,141 +22,1130 @@
 #include <random>
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
 #include <cmath>
+#include <csignal>
+#include <cstring>
+#include <memory>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <optional>
+#include <type_traits>
 
 #include "action.h"
+#include "coro.h"
+#include "discount.h"
+#include "exploitability.h"
 #include "game.h"
-// #include "leduc.h"
+#include "hot.h"
+#include "importance.h"
+#include "leduc.h"
 #include "node.h"
+#include "options.h"
+#include "partition.h"
+#include "pipeline.h"
+#include "public_table.h"
+#include "range.h"
+#include "rng.h"
 #include "settings.h"
+#include "stratified.h"
+#include "topology.h"
+#include "trie.h"
+#include "tree.h"
 #include "utils.h"
 
 using namespace std;
 
 /* Game tree */
-unordered_map<string, Node> g_tree;
+NodeTable g_tree;
+PublicTable g_public;
+TrieTable g_trie;
+/* Accumulated DCFR discounts, nodes are discounted when visited */
+DiscountTable g_discounts;
+/* Storage selected by --layout */
+NodeStore* g_store = &g_tree;
+HotTier g_hot;
 mutex g_mutex;
 mutex g_mutex_iter;
 unsigned int g_iterations = 0;
 bool g_run = true;
+/* Epoch of the next checkpoint, nodes are stamped by it when they change */
+atomic<uint32_t> g_epoch = 1;
+
+/* Training threads with index >= g_active_workers are paused */
+int g_n_workers = 0;
+atomic<int> g_active_workers = 0;
+atomic<int> g_finished_workers = 0;
+mutex g_workers_mutex;
+condition_variable g_workers_cv;
 // std::vector<std::string> g_keys;
 
-float cfr(Holdem &game, int hero) {
+/* Weight of strategy added to average strategy in given iteration */
+static inline float average_weight(unsigned int iteration) {
+    if (g_options.variant == Variant::PLUS || g_options.variant == Variant::LINEAR) {
+        return static_cast<float>(iteration);
+    }
+    return 1;
+}
+
+/* Actions with low regret are pruned except on exploration iterations, so they can recover */
+static inline bool pruning(unsigned int iteration) {
+    if (iteration <= g_options.prune_after) return false;
+    /* Iteration is scrambled first - traversing player alternates with iteration, plain modulo with even period
+       would always explore for the same player */
+    uint32_t scrambled = (iteration * 0x9E3779B1u) >> 8;
+    return g_options.explore_every == 0 || scrambled % g_options.explore_every != 0;
+}
+
+/* Hero actions explored and pruned, counted per thread and added to totals after each traversal */
+struct PruneStats{
+    uint64_t explored = 0;
+    uint64_t pruned = 0;
+};
+static thread_local PruneStats t_prune_stats;
+atomic<uint64_t> g_actions_explored = 0;
+atomic<uint64_t> g_actions_pruned = 0;
+
+/* Node visits by cfr(), visits of frozen nodes and nodes frozen, flushed to totals like PruneStats */
+struct FreezeStats{
+    uint64_t visits = 0;
+    uint64_t frozen = 0;
+    uint64_t freezes = 0;
+};
+static thread_local FreezeStats t_freeze_stats;
+atomic<uint64_t> g_node_visits = 0;
+atomic<uint64_t> g_frozen_visits = 0;
+atomic<uint64_t> g_freezes = 0;
+
+static thread_local mt19937 t_rng(stream_seed());
+
+static inline uint64_t random64() {
+    return (static_cast<uint64_t>(t_rng()) << 32) | t_rng();
+}
+
+/* Probabilities of exploring hero actions in average strategy sampling. Actions are sampled independently, the
+   one with the largest strategy sum always, so every traversal goes on below the node. */
+static array<float, N_ACTIONS> average_sampling(const Node& node, const vector<Action>& valid_actions) {
+    array<float, N_ACTIONS> probabilities;
+    probabilities.fill(1);
+    if (g_options.hero_sampling != HeroSampling::AVERAGE) return probabilities;
+
+    array<float, N_ACTIONS> sums = node.get_strategy_sum();
+    float total = 0;
+    int best = int(valid_actions.front());
+    for (const Action& a : valid_actions) {
+        total += sums[int(a)];
+        if (sums[int(a)] > sums[best]) best = int(a);
+    }
+    for (const Action& a : valid_actions) {
+        float p = (g_options.as_beta + g_options.as_tau * sums[int(a)]) / (g_options.as_beta + total);
+        probabilities[int(a)] = std::clamp(p, g_options.as_epsilon, 1.0f);
+    }
+    probabilities[best] = 1;
+    return probabilities;
+}
+
+/* Stamped after the change is complete, so the change is part of the checkpoint of the stamp */
+static inline void mark_changed(Node& node) { node.set_epoch(g_epoch.load(memory_order_relaxed)); }
+
+/* Preflop nodes are in hot tier guarded by their own locks, others in game tree guarded by the tree lock */
+template <typename Game>
+static inline HotEntry* find_hot(Game& game, int player) {
+    if constexpr (is_same_v<Game, Holdem>) {
+        return g_hot.find(game, player);
+    }
+    return nullptr;
+}
+
+static inline void lock_node(HotEntry* hot) {
+    if (hot) {
+        hot->lock();
+    } else {
+        g_mutex.lock();
+    }
+}
+
+static inline void unlock_node(HotEntry* hot) {
+    if (hot) {
+        hot->unlock();
+    } else {
+        g_mutex.unlock();
+    }
+}
+
+/* Returns node of player to act, creating it if it does not exist yet, and catches up with DCFR discounts. Node
+   has to be locked by lock_node(). Key and its hash are needed only for nodes outside the hot tier. */
+template <typename Game>
+static Node& acquire_node(Game& game, int player, HotEntry* hot, const string& key, uint64_t h,
+                          unsigned int iteration) {
+    Node* found;
+    if (hot) {
+        if (!hot->used) {
+            string hot_key = game.create_key(player);
+            hot->length = static_cast<uint8_t>(hot_key.size());
+            memcpy(hot->key.data(), hot_key.data(), hot->length);
+            hot->node.set_mask(game.get_valid_actions_mask(player));
+            hot->used = true;
+        }
+        found = &hot->node;
+    } else {
+        /* Get existing node from game tree if it exists or create a new one */
+        bool inserted;
+        found = &g_store->get(key, h, inserted);
+        if (inserted){
+            /* New element added -> have to set mask */
+            found->set_mask(game.get_valid_actions_mask(player));
+        }
+    }
+
+    if (g_options.variant == Variant::DCFR) {
+        /* Catch up with discounts of periods since the node was visited last time */
+        uint32_t period = iteration / g_options.discount_every;
+        uint32_t last = found->claim_discount(period);
+        if (last < period) {
+            DiscountTable::Factors f = g_discounts.between(last, period);
+            found->discount(f.positive, f.negative, f.strategy);
+            mark_changed(*found);
+        }
+    }
+    return *found;
+}
+
+/* Traversal is a coroutine, so several of them can be interleaved on one thread (see train_game). Rewards are
+   multiplied by importance weight of the deal, regret updates are summed into chance. */
+template <typename Game>
+Task<float> cfr(Game &game, int hero, unsigned int iteration, ChanceSample& chance) {
     /* check for terminal condition */
     if (!game.is_running()) {
-        return static_cast<float>(game.get_reward(hero));
+        co_return static_cast<float>(game.get_reward(hero)) * chance.weight;
     }
 
     /* Get next player and create game state string for that player */
     int player = game.next_player();
-    string key = game.create_key(player);
+    bool relaxed = g_options.update_mode == UpdateMode::RELAXED;
 
-    /* Get existing node from game tree if it exists or create a new one */
-    g_mutex.lock();
-    size_t count = g_tree.size();
-    Node node = g_tree[key];
-    if (g_tree.size() != count){
-        /* New element added -> have to set mask */
-        node.set_mask(game.get_valid_actions_mask(player));
+    HotEntry* hot = find_hot(game, player);
+    string key;
+    uint64_t h = 0;
+    if (!hot) {
+        key = game.create_key(player);
+
+        /* Node is most likely not in cache - start loading it and let other traversals run meanwhile */
+        h = g_store->hash_key(key);
+        g_store->prefetch(h);
+        co_await Scheduler::yield();
     }
-    g_mutex.unlock();
+
+    lock_node(hot);
+    Node &stored = acquire_node(game, player, hot, key, h, iteration);
+    if (relaxed) unlock_node(hot);
+    /* In relaxed mode, other threads may update the node while it is being read */
+    Node node = relaxed ? stored.load_relaxed() : stored;
+    if (!relaxed) unlock_node(hot);
 
     float node_util = 0.0;
     array<float, N_ACTIONS> strategy = node.get_strategy();
 
+    /* Frozen node is only read - it is traversed as usual, but neither updated nor written back */
+    bool frozen = g_options.freeze_tolerance > 0 && node.is_frozen(iteration);
+    t_freeze_stats.visits++;
+    if (frozen) t_freeze_stats.frozen++;
+
     if (player == hero) {
         /* Full exploration for hero player */
         array<float, N_ACTIONS> utilities{};
         vector<Action> valid_actions = game.get_valid_actions(player);
         std::array<float, N_ACTIONS> regrets = node.get_regrets();
 
-        /* Explore all valid actions */
+        /* Explore all valid actions, or a sample of them. Utility of sampled action is divided by its sampling
+           probability, action not sampled counts with zero utility, so the estimate stays unbiased. With baselines,
+           only difference from the baseline is importance weighted and action not sampled takes the baseline. */
+        bool prune = pruning(iteration);
+        bool baselines = g_options.baselines;
+        array<float, N_ACTIONS> probabilities = average_sampling(node, valid_actions);
+#if PURE_CFR
+        /* Hero plays one pure action, value of the node is its value. Regret matching never picks pruned
+           action, so it is always explored. */
+        int pure = node.sample_pure(random64());
+        probabilities[pure] = 1;
+#endif
+        uniform_real_distribution<float> uniform(0, 1);
+        array<bool, N_ACTIONS> explored{};
         for (Action &a : valid_actions) {
             int a_int = int(a);
 
-            /* If regret is too low, do not explore this particual action */
-            if (regrets[a_int] < REGRET_TRESHOLD) continue;
+            /* If regret is too low, do not explore this particual action. Action still played by the current
+               strategy (all regrets are negative) is explored, so node utility stays correct. */
+            if (prune && regrets[a_int] < g_options.prune_threshold && strategy[a_int] == 0) {
+                t_prune_stats.pruned++;
+                continue;
+            }
+            explored[a_int] = true;
+            float baseline = baselines ? node.get_baseline(a_int) : 0;
+            if (probabilities[a_int] < 1 && uniform(t_rng) >= probabilities[a_int]) {
+                utilities[a_int] = baseline;
+                node_util += baseline * strategy[a_int];
+                continue;
+            }
+            t_prune_stats.explored++;
             
             /* Copy game to prevent overrides down the line */
-            Holdem game_copy = Holdem(game);
+            Game game_copy = Game(game);
             
             /* Take action, perform chance event if applicable */
             game_copy.take_action(a);
 
             /* Explore */
-            utilities[a_int] = cfr(game_copy, hero);
+            float sampled = co_await cfr(game_copy, hero, iteration, chance);
+            utilities[a_int] = baseline + (sampled - baseline) / probabilities[a_int];
             node_util += utilities[a_int] * strategy[a_int];
+
+            /* Baselines of hero actions are needed only when some of them are not sampled */
+            if (baselines && probabilities[a_int] < 1 && !frozen) {
+                if (relaxed) {
+                    stored.update_baseline_atomic(a_int, sampled, g_options.baseline_decay);
+                } else {
+                    node.update_baseline(a_int, sampled, g_options.baseline_decay);
+                }
+            }
         }
+#if PURE_CFR
+        node_util = utilities[pure];
+#endif
+        if (frozen) co_return node_util;
         
         /* Update regret sums */
+        bool plus = g_options.variant == Variant::PLUS;
         float regret_element;
         for (int i = 0; i < N_ACTIONS; i++) {
+            /* Pruned actions keep their regret until they are explored again */
+            if (!explored[i]) continue;
             regret_element = utilities[i] - node_util;
-            node.update_regret_sum(i, regret_element);
+            chance.regret_change += fabs(regret_element);
+            if (relaxed && plus) {
+                stored.update_regret_sum_plus_atomic(i, regret_element);
+            } else if (relaxed) {
+                stored.update_regret_sum_atomic(i, regret_element);
+            } else {
+                node.update_regret_sum(i, regret_element);
+            }
         }
+        if (plus && !relaxed) node.floor_regrets();
         /* Increase # of visits for inspection */
-        node.inc_visits();
+        if (relaxed) {
+            stored.inc_visits_atomic();
+        } else {
+            node.inc_visits();
+        }
 
     } else {
-        /* Sample valid action for other players */
-        Action a = game.sample_action(strategy, node.get_valid_actions(), player);
+        /* Sample valid action for other players. With baselines, the action is sampled from the strategy exactly,
+           without exploration, so the error of its baseline below has zero mean. */
+#if PURE_CFR
+        Action a = game.get_actions()[node.sample_pure(random64())];
+#else
+        Action a = g_options.baselines ? game.sample_action(strategy, player)
+                                       : game.sample_action(strategy, node.get_valid_actions(), player);
+#endif
 
         /* Copy game state and take sampled action*/
-        Holdem game_copy = Holdem(game);        
+        Game game_copy = Game(game);        
         game_copy.take_action(a);
 
         /* Explore further */
-        node_util = cfr(game_copy, hero);
+        node_util = co_await cfr(game_copy, hero, iteration, chance);
+
+        /* Control variate - expected baseline under opponent's strategy plus error of the sampled action's
+           baseline. Action is sampled with its strategy probability, so the error needs no weighting. Chance
+           events dealt after the action are covered by its baseline. Baselines are kept in perspective of the
+           player to act, hero's values are the opposite ones in zero-sum game. */
+        if (g_options.baselines) {
+            int a_int = int(a);
+            float expected = 0;
+            for (int i = 0; i < N_ACTIONS; i++) expected -= strategy[i] * node.get_baseline(i);
+            float sampled = node_util;
+            node_util = expected + sampled + node.get_baseline(a_int);
+            if (relaxed && !frozen) {
+                stored.update_baseline_atomic(a_int, -sampled, g_options.baseline_decay);
+            } else if (!frozen) {
+                node.update_baseline(a_int, -sampled, g_options.baseline_decay);
+            }
+        }
+        if (frozen) co_return node_util;
 
-        /* Update average strategy */
-        node.update_avg_strategy(strategy);
+        /* Update average strategy and increase # of visits for inspection */
+#if PURE_CFR
+        /* Strategy sum counts pure actions played */
+        array<float, N_ACTIONS> played{};
+        played[int(a)] = 1;
+#else
+        const array<float, N_ACTIONS>& played = strategy;
+#endif
+        if (relaxed) {
+            stored.update_avg_strategy_atomic(played, average_weight(iteration) * chance.weight);
+            stored.inc_visits2_atomic();
+        } else {
+            node.update_avg_strategy(played, average_weight(iteration) * chance.weight);
+            node.inc_visits2();
+        }
+    }
 
-        /* Increase # of visits for inspection */
-        node.inc_visits2();
+    /* Average strategy is compared with the one at the start of stable window. Current strategy of regret
+       matching keeps oscillating even in converged nodes, average one settles. */
+    if (g_options.freeze_tolerance > 0) {
+        Node& tracked = relaxed ? stored : node;
+        if (tracked.track_stability(node.get_average_strategy(), g_options.freeze_tolerance, g_options.freeze_window,
+                                    iteration + g_options.freeze_recheck)) {
+            t_freeze_stats.freezes++;
+        }
+    }
+
+    if (!relaxed) {
+        /* Write node back to the tree, entries are never moved so no need to look it up again */
+        lock_node(hot);
+        mark_changed(node);
+        stored = node;
+        unlock_node(hot);
+    } else {
+        mark_changed(stored);
+    }
+
+    co_return node_util;
+};
+
+/* Outcome sampling - one action is sampled at every node, also for hero, whose sampling policy is mixed with
+   uniform one by exploration parameter so all actions keep being tried. Sampled values are importance weighted
+   by probability of the sampled history. opp_reach is probability of opponent's actions, sample_reach
+   probability of sampling the history so far. Returns sampled value of the node for hero. */
+template <typename Game>
+Task<float> outcome_sampling(Game &game, int hero, unsigned int iteration, float opp_reach, float sample_reach) {
+    if (!game.is_running()) {
+        co_return static_cast<float>(game.get_reward(hero));
+    }
+
+    int player = game.next_player();
+    bool relaxed = g_options.update_mode == UpdateMode::RELAXED;
+
+    HotEntry* hot = find_hot(game, player);
+    string key;
+    uint64_t h = 0;
+    if (!hot) {
+        key = game.create_key(player);
+        h = g_store->hash_key(key);
+        g_store->prefetch(h);
+        co_await Scheduler::yield();
+    }
+
+    lock_node(hot);
+    Node &stored = acquire_node(game, player, hot, key, h, iteration);
+    if (relaxed) unlock_node(hot);
+    Node node = relaxed ? stored.load_relaxed() : stored;
+    if (!relaxed) unlock_node(hot);
+
+    array<float, N_ACTIONS> strategy = node.get_strategy();
+    array<uint8_t, N_ACTIONS> valid = node.get_valid_actions();
+    array<float, N_ACTIONS> policy = strategy;
+    if (player == hero) {
+        int n_valid = 0;
+        for (int i = 0; i < N_ACTIONS; i++) n_valid += valid[i];
+        for (int i = 0; i < N_ACTIONS; i++) {
+            policy[i] = valid[i] * g_options.os_epsilon / n_valid + (1 - g_options.os_epsilon) * strategy[i];
+        }
+    }
+    discrete_distribution<int> dist(policy.begin(), policy.end());
+    int a = dist(t_rng);
+
+    Game game_copy = Game(game);
+    game_copy.take_action(game.get_actions()[a]);
+
+    /* Value of sampled child divided by probability of sampling it, other children count as zero */
+    float child_value;
+    if (player == hero) {
+        child_value = co_await outcome_sampling(game_copy, hero, iteration, opp_reach, sample_reach * policy[a]);
+    } else {
+        child_value = co_await outcome_sampling(game_copy, hero, iteration, opp_reach * strategy[a],
+                                                sample_reach * policy[a]);
+    }
+    child_value /= policy[a];
+    float node_value = strategy[a] * child_value;
+
+    if (player == hero) {
+        /* Counterfactual regrets, weighted by opponent's reach over sampling probability */
+        bool plus = g_options.variant == Variant::PLUS;
+        float weight = opp_reach / sample_reach;
+        for (int i = 0; i < N_ACTIONS; i++) {
+            if (!valid[i]) continue;
+            float regret = weight * ((i == a ? child_value : 0) - node_value);
+            if (relaxed && plus) {
+                stored.update_regret_sum_plus_atomic(i, regret);
+            } else if (relaxed) {
+                stored.update_regret_sum_atomic(i, regret);
+            } else {
+                node.update_regret_sum(i, regret);
+            }
+        }
+        if (plus && !relaxed) node.floor_regrets();
+        if (relaxed) {
+            stored.inc_visits_atomic();
+        } else {
+            node.inc_visits();
+        }
+    } else {
+        /* Opponent's strategy weighted by its reach over sampling probability */
+        float weight = opp_reach / sample_reach * average_weight(iteration);
+        if (relaxed) {
+            stored.update_avg_strategy_atomic(strategy, weight);
+            stored.inc_visits2_atomic();
+        } else {
+            node.update_avg_strategy(strategy, weight);
+            node.inc_visits2();
+        }
+    }
+
+    if (!relaxed) {
+        lock_node(hot);
+        mark_changed(node);
+        stored = node;
+        unlock_node(hot);
+    } else {
+        mark_changed(stored);
+    }
+
+    co_return node_value;
+};
+
+/* Checkpoint is a full save of the game tree followed by deltas holding only nodes changed since the checkpoint
+   before. Changed nodes are stamped by epoch of the next checkpoint, taking checkpoint closes the epoch. After
+   MAX_DELTAS deltas, or once they outgrow half of the full save, the next checkpoint is full again and the deltas
+   are dropped. Files are written as tree, tree.delta.1, ..., tree.delta.N, with tree.state pointing to them. */
+static TrainingState g_saved;
+static uintmax_t g_full_bytes = 0;
+static uintmax_t g_delta_bytes = 0;
+
+static string delta_path(const string& path, unsigned int n) { return path + ".delta." + to_string(n); }
+
+static uintmax_t file_bytes(const string& path) {
+    error_code ec;
+    uintmax_t bytes = filesystem::file_size(path, ec);
+    return ec ? 0 : bytes;
+}
+
+/* Remembers checkpoint which was written successfully, the next one continues from it */
+static void checkpoint_written(const TrainingState& state) {
+    g_saved = state;
+    g_full_bytes = file_bytes("tree");
+    g_delta_bytes = 0;
+    for (unsigned int i = 1; i <= state.n_deltas; i++) g_delta_bytes += file_bytes(delta_path("tree", i));
+}
+
+/* State of the next checkpoint, nodes changed from now on belong to the one after it. Nodes must be held. */
+static TrainingState next_checkpoint() {
+    bool full = g_saved.epoch == 0 || g_saved.n_deltas >= MAX_DELTAS || g_delta_bytes > g_full_bytes / 2;
+    return TrainingState{g_iterations, get_master_seed(), g_epoch++, full ? 0 : g_saved.n_deltas + 1};
+}
+
+/* Saves checkpoint, so training can continue by --resume tree. Nodes must not change while they are saved. */
+static bool save_checkpoint(const TrainingState& state) {
+    bool ok;
+    if (state.n_deltas == 0) {
+        ok = saveModel(*g_store, g_hot);
+        if (g_options.layout == Layout::TRIE) {
+            /* Preflop nodes are not in the trie, they are saved with it */
+            vector<pair<string, Node>> hot_nodes;
+            g_hot.for_each([&](const string& key, const Node& node){ hot_nodes.push_back({key, node}); });
+            ok = g_trie.save("tree.trie", hot_nodes) && ok;
+        }
+    } else {
+        ok = saveModel(*g_store, g_hot, delta_path("tree", state.n_deltas), g_saved.epoch);
+    }
+    if (!ok || !save_training_state("tree.state", state)) return false;
+
+    /* Full checkpoint contains all changes of deltas before it */
+    if (state.n_deltas == 0) {
+        for (unsigned int i = 1; i <= g_saved.n_deltas; i++) remove(delta_path("tree", i).c_str());
+    }
+    return true;
+}
+
+/* Child process writing checkpoint, -1 if there is none */
+static pid_t g_snapshot = -1;
+static TrainingState g_snapshot_state;
+static chrono::high_resolution_clock::time_point g_snapshot_start;
+
+/* Checkpoint is saved by a copy of the process made by fork(). The child sees memory as it was at the moment of
+   fork, pages modified by training threads afterwards are copied by the kernel. Training threads wait only while
+   the process is being forked, not while the checkpoint is written. */
+static void start_snapshot() {
+    if (g_snapshot > 0) {
+        cout << "Previous checkpoint is still being written, skipping this one.\n";
+        return;
+    }
+    /* Otherwise the child would print buffered output once more */
+    cout.flush();
+
+    g_mutex.lock();
+    g_hot.lock_all();
+    TrainingState state = next_checkpoint();
+    pid_t pid = fork();
+    if (pid == 0) {
+        /* Only this thread exists in the child, locks it holds are not needed there */
+        bool ok = save_checkpoint(state);
+        cout.flush();
+        _exit(ok ? 0 : 1);
+    }
+    if (pid < 0) {
+        cout << "Cannot fork, saving checkpoint while training waits.\n";
+        if (save_checkpoint(state)) checkpoint_written(state);
+    }
+    g_hot.unlock_all();
+    g_mutex.unlock();
+
+    if (pid > 0) {
+        g_snapshot = pid;
+        g_snapshot_state = state;
+        g_snapshot_start = chrono::high_resolution_clock::now();
+    }
+}
+
+/* Reaps child writing checkpoint once it finishes, wait blocks until then */
+static void finish_snapshot(bool wait) {
+    if (g_snapshot < 0) return;
+    int status;
+    pid_t pid = waitpid(g_snapshot, &status, wait ? 0 : WNOHANG);
+    if (pid == 0) return;
+
+    chrono::duration<float> elapsed = chrono::high_resolution_clock::now() - g_snapshot_start;
+    bool ok = pid == g_snapshot && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    cout << (ok ? "Checkpoint written" : "Writing checkpoint failed") << " after " << elapsed.count() << " s.\n";
+    if (ok) checkpoint_written(g_snapshot_state);
+    g_snapshot = -1;
+}
+
+/* Loads game tree of checkpoint with its deltas and restores iteration counter and random streams */
+static void resume(const string& path) {
+    TrainingState state;
+    if (!load_training_state(path + ".state", state)) {
+        cout << "Cannot read " << path << ".state, iterations start from 0.\n";
+        state = TrainingState{0, get_master_seed()};
+    }
+
+    auto t1 = chrono::high_resolution_clock::now();
+    int n_threads = max(1, static_cast<int>(detect_cpu_budget().available));
+    size_t n_nodes;
+    /* Training on part of the tree with restored iteration counter would look like resumed one, so missing or
+       cut file is fatal */
+    if (g_options.layout == Layout::TRIE && TrieTable::count_saved(path + ".trie") > 0) {
+        /* Saved trie is loaded in its own form, keys are not inserted one by one */
+        if (!g_trie.load(path + ".trie")) {
+            cout << "Cannot load " << path << ".trie.\n";
+            exit(1);
+        }
+        n_nodes = g_trie.size();
+    } else if (!load_checkpoint(path, *g_store, n_threads, n_nodes)) {
+        exit(1);
+    }
+    for (unsigned int i = 1; i <= state.n_deltas; i++) {
+        size_t n_delta;
+        if (!load_checkpoint(delta_path(path, i), *g_store, n_threads, n_delta)) exit(1);
+        n_nodes += n_delta;
+    }
+    chrono::duration<float> elapsed = chrono::high_resolution_clock::now() - t1;
+
+    g_iterations = state.iterations;
+    set_master_seed(state.seed, state.iterations);
+    /* Crash between writing full checkpoint and its state leaves state of the previous one, epoch continues after
+       the latest node loaded, so nodes changed from now on win over the loaded ones in the next resume */
+    uint32_t max_epoch = state.epoch;
+    g_store->for_each([&](const string&, Node& node){ max_epoch = max(max_epoch, node.get_epoch()); });
+    g_epoch = max_epoch + 1;
+
+    /* Checkpoint keeps preflop nodes with the others, they are moved to hot tier before training starts. Copy
+       left in the tree is cleared, so it is not saved again. */
+    if (g_hot.enabled()) {
+        size_t n_moved = 0;
+        g_hot.for_each_entry([&](const string& key, HotEntry& e){
+            if (g_store->find(key) == nullptr) return;
+            bool inserted;
+            Node& stored = g_store->get(key, g_store->hash_key(key), inserted);
+            e.length = static_cast<uint8_t>(key.size());
+            memcpy(e.key.data(), key.data(), e.length);
+            e.node = stored;
+            e.used = true;
+            mark_changed(e.node);
+            stored = Node();
+            n_moved++;
+        });
+        cout << "Moved " << n_moved << " preflop nodes of checkpoint to hot tier.\n";
+    }
+    /* Deltas can follow the loaded checkpoint only if it is the one checkpoints are written to */
+    if (path == "tree") checkpoint_written(state);
+    cout << "Resumed " << n_nodes << " nodes from " << path << " and " << state.n_deltas << " delta(s) in "
+         << elapsed.count() << " s, continuing after iteration " << g_iterations << ".\n";
+}
+
+void init_tree() {
+    const Topology& topology = get_topology();
+    print_topology(topology);
+    if (g_options.numa_mode == NumaMode::PARTITION && !g_options.pin_threads) {
+        cout << "NUMA partition needs pinned threads, enabling --pin.\n";
+        g_options.pin_threads = true;
+    }
+    if (g_options.numa_mode != NumaMode::NONE) {
+        bool interleave = g_options.numa_mode == NumaMode::INTERLEAVE;
+        cout << "Game tree is " << (interleave ? "interleaved over " : "partitioned between ") << topology.nodes.size()
+             << " NUMA node(s).\n";
+    }
+
+    /* Integer counters of PURE_CFR count unit updates - iteration weights overflow them within tens of thousands
+       of iterations and fractional weights round to zero */
+    if (PURE_CFR && g_options.variant != Variant::VANILLA) {
+        cout << "Weighted average and discounting are not available with PURE_CFR, using vanilla CFR.\n";
+        g_options.variant = Variant::VANILLA;
+    }
+    if (PURE_CFR && (g_options.sampling == Sampling::OUTCOME || g_options.sampling == Sampling::PUBLIC)) {
+        cout << "Only external sampling is available with PURE_CFR, using it.\n";
+        g_options.sampling = Sampling::EXTERNAL;
+    }
+    if (PURE_CFR && g_options.dealing == Dealing::IMPORTANCE) {
+        cout << "Importance sampling of cards weights updates, not available with PURE_CFR, dealing at random.\n";
+        g_options.dealing = Dealing::RANDOM;
+    }
+
+    if (g_options.variant == Variant::DCFR) {
+        g_discounts.init(g_options.dcfr_alpha, g_options.dcfr_beta, g_options.dcfr_gamma);
+        if (N_ITERATIONS / g_options.discount_every > MAX_DISCOUNT_PERIODS) {
+            cout << "Discounting stops after " << MAX_DISCOUNT_PERIODS << " periods.\n";
+        }
+    }
+
+    if (g_options.sampling == Sampling::PUBLIC && g_options.game != GameType::HOLDEM) {
+        cout << "Public chance sampling is available for Holdem only, using external sampling.\n";
+        g_options.sampling = Sampling::EXTERNAL;
+    }
+    if (g_options.dealing == Dealing::IMPORTANCE && g_options.sampling != Sampling::EXTERNAL) {
+        cout << "Importance sampling of cards is available with external sampling only, dealing at random.\n";
+        g_options.dealing = Dealing::RANDOM;
+    }
+    if (g_options.sampling == Sampling::PUBLIC && g_options.hot_tier) {
+        cout << "Public chance sampling looks nodes up by key, ignoring --hot-tier.\n";
+        g_options.hot_tier = false;
+    }
+
+    if (g_options.hot_tier && g_options.game == GameType::HOLDEM) {
+        g_hot.init();
+        cout << "Preflop nodes kept in hot tier of " << g_hot.size() << " entries.\n";
+    }
+
+    if (g_options.layout == Layout::PUBLIC) {
+        g_store = &g_public;
+        cout << "Game tree nodes grouped by public state.\n";
+    } else if (g_options.layout == Layout::TRIE) {
+        g_store = &g_trie;
+        cout << "Game tree keys stored in trie.\n";
+    }
+    g_store->set_page_mode(g_options.huge_pages, g_options.prefault);
+    g_store->set_numa_mode(g_options.numa_mode, static_cast<int>(topology.nodes.size()));
+
+    size_t n_nodes = g_options.expected_nodes;
+    if (!g_options.presize_from.empty()) {
+        n_nodes = max(n_nodes, count_saved_nodes(g_options.presize_from));
+    }
+    if (n_nodes > 0) {
+        g_store->reserve(n_nodes);
+        cout << "Game tree pre-sized for " << n_nodes << " nodes, " << g_store->bucket_count() << " buckets.\n";
+    }
+
+    if (!g_options.resume_from.empty()) {
+        resume(g_options.resume_from);
+    }
+}
+
+void init_workers(int n_workers, int n_active) {
+    g_n_workers = n_workers;
+    g_active_workers = n_active;
+}
+
+void set_active_workers(int n_active) {
+    n_active = clamp(n_active, 0, g_n_workers);
+    if (n_active == g_active_workers) return;
+    cout << "Active training threads: " << g_active_workers << " -> " << n_active << "\n";
+    {
+        lock_guard<mutex> lock(g_workers_mutex);
+        g_active_workers = n_active;
+    }
+    g_workers_cv.notify_all();
+}
+
+static void stop_workers() {
+    {
+        lock_guard<mutex> lock(g_workers_mutex);
+        g_run = false;
+    }
+    g_workers_cv.notify_all();
+    stop_pipeline();
+}
+
+/* Reads number of active threads from workers file, file is re-read only when it was modified */
+static void check_workers_file() {
+    static filesystem::file_time_type last_write;
+    if (g_options.workers_file.empty()) return;
+
+    error_code ec;
+    filesystem::file_time_type write_time = filesystem::last_write_time(g_options.workers_file, ec);
+    if (ec || write_time == last_write) return;
+    last_write = write_time;
+
+    ifstream f(g_options.workers_file);
+    int n_active;
+    if (f >> n_active) {
+        set_active_workers(n_active);
+    }
+}
+
+static void setup_worker(int worker) {
+    /* Stream 0 is left to the main thread */
+    set_thread_stream(worker + 1);
+    if (g_options.pin_threads) {
+        const Topology& topology = get_topology();
+        int cpu = cpu_for_worker(topology, worker);
+        if (pin_thread(cpu)) {
+            set_current_numa_node(numa_node_of_cpu(topology, cpu));
+            g_mutex.lock();
+            cout << "Training thread " << worker << " pinned to CPU " << cpu << " on NUMA node "
+                 << current_numa_node() << ".\n";
+            g_mutex.unlock();
+        }
+    }
+    /* Buffers of this thread are allocated from now on, keep them on the local node */
+    if (g_options.numa_mode != NumaMode::NONE) {
+        set_local_memory_policy();
+    }
+}
+
+/* Public chance sampling - only the board is sampled, betting tree is traversed once for all private hands of
+   both players. Hero's values and opponent's reach probabilities are vectors over hands of the range. Hands of
+   one bucket share node, their regret and strategy updates are summed. */
+static void public_traversal(Holdem& game, int hero, unsigned int iteration, const Range& range,
+                             const vector<float>& opp_reach, vector<float>& values) {
+    size_t n = range.size();
+    if (!game.is_running()) {
+        int opponent = (hero + 1) % N_PLAYERS;
+        if (game.is_player_in_game(hero) && game.is_player_in_game(opponent)) {
+            float hero_bet = static_cast<float>(game.get_player_pot_contribution(hero));
+            float opponent_bet = static_cast<float>(game.get_player_pot_contribution(opponent));
+            range.showdown_values(opp_reach, opponent_bet, -hero_bet, (opponent_bet - hero_bet) / 2, values);
+        } else {
+            range.fold_values(opp_reach, static_cast<float>(game.get_reward(hero)), values);
+        }
+        return;
+    }
+
+    int player = game.next_player();
+    int round = static_cast<int>(game.get_round());
+    size_t n_buckets = range.n_buckets(round);
+    bool relaxed = g_options.update_mode == UpdateMode::RELAXED;
+
+    /* Opponent's buckets no hand reaches are skipped, their nodes are not even created */
+    vector<bool> active(n_buckets, player == hero);
+    if (player != hero) {
+        for (size_t i = 0; i < n; i++) {
+            if (opp_reach[i] > 0) active[range.bucket(round, i)] = true;
+        }
+    }
+
+    /* Keys are hashed and nodes prefetched first, so loads of all nodes overlap */
+    vector<string> keys(n_buckets);
+    vector<uint64_t> hashes(n_buckets);
+    for (size_t b = 0; b < n_buckets; b++) {
+        if (!active[b]) continue;
+        keys[b] = game.create_key(player, range.bucket_str(round, b));
+        hashes[b] = g_store->hash_key(keys[b]);
+        g_store->prefetch(hashes[b]);
     }
 
-    /* Write node back to the tree */
+    vector<Node*> stored(n_buckets, nullptr);
+    vector<array<float, N_ACTIONS>> strategies(n_buckets);
     g_mutex.lock();
-    g_tree[key] = node;
+    for (size_t b = 0; b < n_buckets; b++) {
+        if (!active[b]) continue;
+        stored[b] = &acquire_node(game, player, nullptr, keys[b], hashes[b], iteration);
+        strategies[b] = relaxed ? stored[b]->load_relaxed().get_strategy() : stored[b]->get_strategy();
+    }
     g_mutex.unlock();
 
-    return node_util;
+    vector<Action> valid_actions = game.get_valid_actions(player);
+    vector<float> strategy(n), child(n);
+    /* Sums over hands of each bucket - values of actions for hero, reach of actions for opponent */
+    vector<array<float, N_ACTIONS>> sums(n_buckets, array<float, N_ACTIONS>{});
+    values.assign(n, 0);
+
+    for (Action& a : valid_actions) {
+        int a_int = int(a);
+        for (size_t i = 0; i < n; i++) strategy[i] = strategies[range.bucket(round, i)][a_int];
+
+        Holdem game_copy = Holdem(game);
+        game_copy.take_action(a);
+
+        if (player == hero) {
+            public_traversal(game_copy, hero, iteration, range, opp_reach, child);
+            for (size_t i = 0; i < n; i++) {
+                values[i] += strategy[i] * child[i];
+                sums[range.bucket(round, i)][a_int] += child[i];
+            }
+        } else {
+            vector<float> reach(n);
+            float total = 0;
+            for (size_t i = 0; i < n; i++) {
+                reach[i] = opp_reach[i] * strategy[i];
+                total += reach[i];
+                sums[range.bucket(round, i)][a_int] += reach[i];
+            }
+            if (total == 0) continue;
+            public_traversal(game_copy, hero, iteration, range, reach, child);
+            for (size_t i = 0; i < n; i++) values[i] += child[i];
+        }
+    }
+
+    if (player == hero) {
+        /* Regret of action is its value less value of the node, summed over hands of the bucket */
+        vector<float> node_values(n_buckets, 0);
+        for (size_t i = 0; i < n; i++) node_values[range.bucket(round, i)] += values[i];
+
+        bool plus = g_options.variant == Variant::PLUS;
+        if (!relaxed) g_mutex.lock();
+        for (size_t b = 0; b < n_buckets; b++) {
+            for (Action& a : valid_actions) {
+                int a_int = int(a);
+                float regret = sums[b][a_int] - node_values[b];
+                if (relaxed && plus) {
+                    stored[b]->update_regret_sum_plus_atomic(a_int, regret);
+                } else if (relaxed) {
+                    stored[b]->update_regret_sum_atomic(a_int, regret);
+                } else {
+                    stored[b]->update_regret_sum(a_int, regret);
+                }
+            }
+            if (relaxed) {
+                stored[b]->inc_visits_atomic();
+            } else {
+                if (plus) stored[b]->floor_regrets();
+                stored[b]->inc_visits();
+            }
+            mark_changed(*stored[b]);
+        }
+        if (!relaxed) g_mutex.unlock();
+    } else {
+        /* Average strategy is weighted by opponent's reach of the bucket */
+        if (!relaxed) g_mutex.lock();
+        for (size_t b = 0; b < n_buckets; b++) {
+            if (!active[b]) continue;
+            if (relaxed) {
+                stored[b]->update_avg_strategy_atomic(sums[b], average_weight(iteration));
+                stored[b]->inc_visits2_atomic();
+            } else {
+                stored[b]->update_avg_strategy(sums[b], average_weight(iteration));
+                stored[b]->inc_visits2();
+            }
+            mark_changed(*stored[b]);
+        }
+        if (!relaxed) g_mutex.unlock();
+    }
+}
+
+static thread_local Range t_range;
+
+/* Runs public chance sampling on the board of the game, returns mean value of hero's hands */
+template <typename Game>
+Task<float> public_chance_sampling(Game& game, int hero, unsigned int iteration) {
+    float util = 0;
+    if constexpr (is_same_v<Game, Holdem>) {
+        t_range.init(game);
+        size_t n = t_range.size();
+        /* Opponent's hands are equally likely, so hero's values are expected payoffs */
+        vector<float> opp_reach(n, 1.0f / static_cast<float>(n));
+        vector<float> values(n);
+        public_traversal(game, hero, iteration, t_range, opp_reach, values);
+        for (float v : values) util += v;
+        util /= static_cast<float>(n);
+    }
+    co_return util;
+}
+
+template <typename Game> unique_ptr<Game> new_game();
+
+template <> unique_ptr<Holdem> new_game<Holdem>() {
+    return make_unique<Holdem>(N_PLAYERS, BIG_BLIND, SMALL_BLIND, MAX_RERAISES);
+}
+
+template <> unique_ptr<Leduc> new_game<Leduc>() { return make_unique<Leduc>(BIG_BLIND, SMALL_BLIND, MAX_RERAISES); }
+
+/* One game being explored by cfr() */
+template <typename Game>
+struct Traversal{
+    unique_ptr<Game> game;
+    optional<Task<float>> task;
+    /* Cards of the game when it was dealt by dealer thread */
+    Deal deal;
+    /* Importance sampled deal, stratum of hero's cards */
+    ChanceSample chance;
+    int stratum = -1;
 };
 
-void train() {
+template <typename Game>
+static void train_game(int worker) {
     long int util = 0;
-    array<float, N_PLAYERS> probs;
-    int i = 0; 
     int hero = 0;   
 
+    /* Several traversals are interleaved - when one waits for a node to be loaded from memory, the others run.
+       With single traversal, there is no scheduler and traversal never yields. */
+    int n_traversals = max(1, g_options.interleave);
+    optional<Scheduler> scheduler;
+    if (n_traversals > 1) scheduler.emplace();
+    vector<Traversal<Game>> traversals(n_traversals);
+
+    /* Threads start in different partitions, so all of them are being trained at any time */
+    optional<HandPartition> partition;
+    if (is_same_v<Game, Holdem> && g_options.n_partitions > 0) {
+        partition.emplace(g_options.n_partitions, worker * g_options.n_partitions / max(1, g_n_workers));
+    }
+
+    /* Each thread follows its own randomly shifted sequence */
+    optional<StratifiedDealer> stratified;
+    if (g_options.dealing == Dealing::STRATIFIED) stratified.emplace();
+    /* Each thread learns its own sampling probabilities */
+    optional<conditional_t<is_same_v<Game, Holdem>, HoldemImportance, LeducImportance>> importance;
+    if (g_options.dealing == Dealing::IMPORTANCE) importance.emplace(g_options.importance_mix);
+
     while (g_run) {
-        g_mutex_iter.lock();
-        g_iterations++;
-        g_mutex_iter.unlock();
+        if (worker >= g_active_workers) {
+            /* Paused, wait until activated again */
+            unique_lock<mutex> lock(g_workers_mutex);
+            g_workers_cv.wait(lock, [&]{ return worker < g_active_workers || !g_run; });
+            continue;
+        }
 
-        Holdem game = Holdem(N_PLAYERS, BIG_BLIND, SMALL_BLIND, MAX_RERAISES);
-        // Leduc game = Leduc(BIG_BLIND, SMALL_BLIND, MAX_RERAISES);
-        game.start_game();
+        for (Traversal<Game>& t : traversals) {
+            if (t.task && !t.task->done()) continue;
+            if (t.task) util += t.task->result();
+            if (importance && t.stratum >= 0) {
+                importance->update(t.stratum, t.chance.regret_change / t.chance.weight);
+            }
+            t.chance = ChanceSample();
+            t.stratum = -1;
+            g_actions_explored.fetch_add(t_prune_stats.explored, memory_order_relaxed);
+            g_actions_pruned.fetch_add(t_prune_stats.pruned, memory_order_relaxed);
+            t_prune_stats = PruneStats();
+            g_node_visits.fetch_add(t_freeze_stats.visits, memory_order_relaxed);
+            g_frozen_visits.fetch_add(t_freeze_stats.frozen, memory_order_relaxed);
+            g_freezes.fetch_add(t_freeze_stats.freezes, memory_order_relaxed);
+            t_freeze_stats = FreezeStats();
 
-        /* Explore */
-        util += cfr(game, hero);
-        
-        /* Change traversal player */
-        hero = (hero + 1) % N_PLAYERS;
+            g_mutex_iter.lock();
+            unsigned int iteration = ++g_iterations;
+            g_mutex_iter.unlock();
+
+            t.game = new_game<Game>();
+            if constexpr (is_same_v<Game, Holdem>) {
+                if (partition) {
+                    t.game->start_game(hero, partition->sample());
+                } else if (take_deal(worker, t.deal)) {
+                    t.game->start_game(t.deal);
+                } else if (stratified) {
+                    t.game->start_game(stratified->deal_holdem(hero));
+                } else if (importance) {
+                    t.game->start_game(hero, importance->sample(t.stratum, t.chance.weight));
+                } else {
+                    t.game->start_game();
+                }
+            } else if (stratified) {
+                t.game->start_game(stratified->deal_leduc());
+            } else if (importance) {
+                t.game->start_game(importance->sample(hero, t.stratum, t.chance.weight));
+            } else {
+                t.game->start_game();
+            }
+
+            /* Explore, runs until the first yield */
+            if (g_options.sampling == Sampling::OUTCOME) {
+                t.task = outcome_sampling(*t.game, hero, iteration, 1.0f, 1.0f);
+            } else if (g_options.sampling == Sampling::PUBLIC) {
+                t.task = public_chance_sampling(*t.game, hero, iteration);
+            } else {
+                t.task = cfr(*t.game, hero, iteration, t.chance);
+            }
+            t.task->start();
+
+            /* Change traversal player */
+            hero = (hero + 1) % N_PLAYERS;
+        }
+
+        if (scheduler) scheduler->step();
+    }
+
+    /* Suspended traversals are destroyed before the scheduler that would resume them */
+    traversals.clear();
+}
+
+void train(int worker) {
+    setup_worker(worker);
+
+    if (g_options.game == GameType::LEDUC) {
+        train_game<Leduc>(worker);
+    } else {
+        train_game<Holdem>(worker);
     }
+    g_finished_workers++;
 };
 
+/* Copy of node for evaluation while training threads keep running */
+static bool lookup_node(const string& key, Node& node) {
+    lock_guard<mutex> lock(g_mutex);
+    const Node* stored = g_store->find(key);
+    if (stored == nullptr) return false;
+    node = g_options.update_mode == UpdateMode::RELAXED ? stored->load_relaxed() : *stored;
+    return true;
+}
+
+/* Set on SIGTERM, monitor then stops training and saves final checkpoint */
+static volatile sig_atomic_t g_terminate = 0;
+
+static void handle_sigterm(int) { g_terminate = 1; }
+
 void monitor(){
+    signal(SIGTERM, handle_sigterm);
     auto t1 = chrono::high_resolution_clock::now();
+    auto t_last = t1;
+    unsigned int last_iterations = 0;
+    uint64_t last_explored = 0, last_pruned = 0;
+    uint64_t last_visits = 0, last_frozen = 0;
     bool saved = true; /* True to skip the first minute save */
+    bool target_reached = false;
 
     while(true){
         if (g_iterations >= N_ITERATIONS) {
-            g_run = false;
+            stop_workers();
+            finish_snapshot(true);
             break;
         }
 
-        std::this_thread::sleep_for(30s);
+        for (int i = 0; i < 30 && !g_terminate; i++) {
+            check_workers_file();
+            finish_snapshot(false);
+            std::this_thread::sleep_for(1s);
+        }
+        if (g_terminate) {
+            cout << "Terminated, saving final checkpoint.\n";
+            stop_workers();
+            /* Background checkpoint writes the same files */
+            finish_snapshot(true);
+            while (g_finished_workers < g_n_workers) std::this_thread::sleep_for(10ms);
+            TrainingState state = next_checkpoint();
+            if (save_checkpoint(state)) checkpoint_written(state);
+            break;
+        }
 
         auto t2 = std::chrono::high_resolution_clock::now();
         chrono::duration<float> elapsed = t2 - t1;
@@ -164,10 +1153,54 @@ void monitor(){
         int minutes = (static_cast<int>(elapsed.count()) % 3600) / 60;
         int seconds = (static_cast<int>(elapsed.count()) % 3600) % 60;
 
+        /* Throughput since the last report */
+        unsigned int iterations = g_iterations;
+        chrono::duration<float> interval = t2 - t_last;
+        float it_per_s = (iterations - last_iterations) / interval.count();
+        t_last = t2;
+        last_iterations = iterations;
+
+        /* Share of hero actions pruned since the last report */
+        uint64_t explored = g_actions_explored.load(memory_order_relaxed);
+        uint64_t pruned = g_actions_pruned.load(memory_order_relaxed);
+        uint64_t n_actions = explored - last_explored + pruned - last_pruned;
+        float pruned_share = n_actions > 0 ? 100.0f * (pruned - last_pruned) / n_actions : 0;
+        last_explored = explored;
+        last_pruned = pruned;
+
+        /* Share of node visits that found the node frozen since the last report */
+        uint64_t visits = g_node_visits.load(memory_order_relaxed);
+        uint64_t frozen = g_frozen_visits.load(memory_order_relaxed);
+        float frozen_share = visits > last_visits ? 100.0f * (frozen - last_frozen) / (visits - last_visits) : 0;
+        last_visits = visits;
+        last_frozen = frozen;
+
         cout << "Iteration: " << (g_iterations+1) << ", memory used: " << get_ram_usage() << " kb, " << "# of nodes: " 
-             << g_tree.size() << ", elapsed time: " << hours << "h " << minutes << "m " << seconds << "s\n";
+             << g_store->size() << " (" << (g_store->bytes_used() >> 20) << " MB, " << g_store->bytes_per_node()
+             << " B/node), threads: " << g_active_workers << "/" << g_n_workers << ", it/s: " << static_cast<int>(it_per_s) << ", elapsed time: " << hours << "h "
+             << minutes << "m " << seconds << "s";
+        cout << ", pruned: " << pruned_share << "%";
+        if (g_options.freeze_tolerance > 0) {
+            cout << ", frozen: " << frozen_share << "% of visits, " << g_freezes.load(memory_order_relaxed)
+                 << " freezes";
+        }
+        if (g_options.n_dealers > 0) {
+            cout << ", self-dealt games: " << get_deal_misses();
+        }
+        float exploitability = 0;
+        if (g_options.game == GameType::LEDUC) {
+            exploitability = leduc_exploitability(lookup_node);
+            cout << ", exploitability: " << exploitability << " chips/game";
+        }
+        cout << "\n";
+        if (g_options.game == GameType::LEDUC && g_options.target_exploitability > 0 && !target_reached &&
+            exploitability <= g_options.target_exploitability) {
+            cout << "Exploitability " << g_options.target_exploitability << " reached after " << iterations
+                 << " iterations.\n";
+            target_reached = true;
+        }
         if ((minutes % SAVE_EVERY) == 0 && !saved) {
-            saveModel(g_tree);
+            start_snapshot();
             // save_card_combination_keys(g_keys);
             saved = true;
         } else if ((minutes % SAVE_EVERY) != 0) {
@@ -0,0 +1,174 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "tree.h"
+
+#include <new>
+
+NodeTable::NodeTable()
+    : m_numa_mode(NumaMode::NONE)
+    , m_buckets(allocate_buckets(TABLE_MIN_BUCKETS))
+    , m_mask(TABLE_MIN_BUCKETS - 1)
+    , m_old(nullptr)
+    , m_old_mask(0)
+    , m_rehash_idx(0) {}
+
+NodeTable::~NodeTable() {
+    /* Entries are released together with the arena */
+    free_buckets(m_buckets, m_mask + 1);
+    if (m_old != nullptr) free_buckets(m_old, m_old_mask + 1);
+}
+
+void NodeTable::set_numa_mode(NumaMode mode, int n_numa_nodes) {
+    m_numa_mode = mode;
+    m_entries.set_numa_mode(mode, n_numa_nodes);
+
+    /* Initial bucket array was allocated before NUMA mode was known */
+    if (mode != NumaMode::NONE && m_old == nullptr && size() == 0) {
+        free_buckets(m_buckets, m_mask + 1);
+        m_buckets = allocate_buckets(m_mask + 1);
+    }
+}
+
+uint64_t NodeTable::hash(const std::string& key) noexcept { return std::hash<std::string>{}(key); }
+
+bool NodeTable::matches(const Entry& e, const std::string& key, uint64_t h) noexcept {
+    /* Longer key than fits into entry never matches */
+    return e.hash == static_cast<uint32_t>(h) && e.length == key.size() &&
+           std::memcmp(e.key.data(), key.data(), key.size()) == 0;
+}
+
+uint32_t* NodeTable::allocate_buckets(size_t n_buckets) {
+    /* Fresh mapping is zeroed by the kernel, so even huge bucket arrays are allocated in no time - pages get
+       touched lazily during migration. Buckets are accessed by all threads, so they are interleaved over NUMA
+       nodes whenever NUMA placement is requested. */
+    int numa_node = m_numa_mode == NumaMode::NONE ? NUMA_DEFAULT : NUMA_INTERLEAVE;
+    return static_cast<uint32_t*>(map_region(n_buckets * sizeof(uint32_t), HugePages::NONE, false, numa_node));
+}
+
+void NodeTable::free_buckets(uint32_t* buckets, size_t n_buckets) noexcept {
+    unmap_region(buckets, n_buckets * sizeof(uint32_t));
+}
+
+Node& NodeTable::get(const std::string& key, bool& inserted) { return get(key, hash(key), inserted); }
+
+Node& NodeTable::get(const std::string& key, uint64_t h, bool& inserted) {
+    if (m_old != nullptr) rehash_step(REHASH_STEP);
+
+    /* Not yet migrated part of the old table */
+    if (m_old != nullptr) {
+        size_t idx = h & m_old_mask;
+        if (idx >= m_rehash_idx) {
+            for (uint32_t i = m_old[idx]; i != Arena<Entry>::NONE; i = m_entries.at(i).next) {
+                Entry& e = m_entries.at(i);
+                if (matches(e, key, h)) {
+                    inserted = false;
+                    return e.node;
+                }
+            }
+        }
+    }
+
+    size_t idx = h & m_mask;
+    for (uint32_t i = m_buckets[idx]; i != Arena<Entry>::NONE; i = m_entries.at(i).next) {
+        Entry& e = m_entries.at(i);
+        if (matches(e, key, h)) {
+            inserted = false;
+            return e.node;
+        }
+    }
+
+    uint32_t i = m_entries.allocate(current_numa_node());
+    Entry& e = m_entries.at(i);
+    e.length = static_cast<uint8_t>(key.size());
+    std::memcpy(e.key.data(), key.data(), e.length);
+    e.hash = static_cast<uint32_t>(h);
+    e.next = m_buckets[idx];
+    m_buckets[idx] = i;
+    inserted = true;
+
+    if (size() > m_mask + 1) {
+        start_rehash(2 * (m_mask + 1));
+    }
+    return e.node;
+}
+
+const Node* NodeTable::find(const std::string& key) const noexcept {
+    uint64_t h = hash(key);
+    if (m_old != nullptr && (h & m_old_mask) >= m_rehash_idx) {
+        for (uint32_t i = m_old[h & m_old_mask]; i != Arena<Entry>::NONE; i = m_entries.at(i).next) {
+            if (matches(m_entries.at(i), key, h)) return &m_entries.at(i).node;
+        }
+    }
+    for (uint32_t i = m_buckets[h & m_mask]; i != Arena<Entry>::NONE; i = m_entries.at(i).next) {
+        if (matches(m_entries.at(i), key, h)) return &m_entries.at(i).node;
+    }
+    return nullptr;
+}
+
+void NodeTable::reserve(size_t n_nodes) {
+    size_t n_buckets = TABLE_MIN_BUCKETS;
+    while (n_buckets < n_nodes) n_buckets *= 2;
+    if (n_buckets > m_mask + 1) {
+        start_rehash(n_buckets);
+    }
+    m_entries.reserve(n_nodes);
+}
+
+void NodeTable::start_rehash(size_t n_buckets) {
+    /* Previous migration has to be finished first. It happens only if the table doubled during migration,
+       which is rare as migration moves several buckets per access. */
+    while (m_old != nullptr) rehash_step(REHASH_STEP);
+
+    m_old = m_buckets;
+    m_old_mask = m_mask;
+    m_rehash_idx = 0;
+    /* Stored atomically, prefetch() reads them without lock */
+    std::atomic_ref<uint32_t*>(m_buckets).store(allocate_buckets(n_buckets), std::memory_order_relaxed);
+    std::atomic_ref<size_t>(m_mask).store(n_buckets - 1, std::memory_order_relaxed);
+}
+
+void NodeTable::rehash_step(int n_buckets) noexcept {
+    /* Empty buckets are cheap to skip, limit them anyway so one step stays short */
+    int empty_visits = 10 * n_buckets;
+    size_t old_buckets = m_old_mask + 1;
+
+    while (n_buckets > 0 && m_rehash_idx < old_buckets) {
+        uint32_t i = m_old[m_rehash_idx];
+        if (i == Arena<Entry>::NONE) {
+            m_rehash_idx++;
+            if (--empty_visits == 0) return;
+            continue;
+        }
+        while (i != Arena<Entry>::NONE) {
+            Entry& e = m_entries.at(i);
+            uint32_t next = e.next;
+            size_t idx = e.hash & m_mask;
+            e.next = m_buckets[idx];
+            m_buckets[idx] = i;
+            i = next;
+        }
+        m_old[m_rehash_idx++] = Arena<Entry>::NONE;
+        n_buckets--;
+    }
+
+    if (m_rehash_idx == old_buckets) {
+        free_buckets(m_old, old_buckets);
+        m_old = nullptr;
+        m_old_mask = 0;
+        m_rehash_idx = 0;
+    }
+}
@@ -0,0 +1,267 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "trie.h"
+
+#include <cstdio>
+#include <cstring>
+
+static const char TRIE_MAGIC[4] = {'T', 'R', 'I', 'E'};
+
+TrieTable::TrieTable() : m_label_bytes(0) { m_root = add_node(0, 0); }
+
+std::string_view TrieTable::strip(const std::string& key) noexcept {
+    size_t length = key.size();
+    while (length > 0 && key[length - 1] == ' ') length--;
+    return std::string_view(key.data(), length);
+}
+
+uint32_t TrieTable::add_label(std::string_view s) {
+    /* Root has empty label, it does not need any chunk */
+    if (s.empty()) return 0;
+    size_t chunk_size = size_t(1) << LABEL_CHUNK_BITS;
+    /* Label never crosses chunk boundary, new chunk is started also when the last one is exactly full */
+    if (m_label_bytes + s.size() > m_labels.size() * chunk_size) {
+        m_labels.push_back(std::make_unique<char[]>(chunk_size));
+        m_label_bytes = (m_labels.size() - 1) * chunk_size;
+    }
+    uint32_t idx = static_cast<uint32_t>(m_label_bytes);
+    std::memcpy(m_labels.back().get() + (m_label_bytes & (chunk_size - 1)), s.data(), s.size());
+    m_label_bytes += s.size();
+    return idx;
+}
+
+uint32_t TrieTable::add_node(uint32_t label, uint8_t length) {
+    uint32_t idx = m_trie.allocate();
+    TrieNode& n = m_trie.at(idx);
+    n.child = n.sibling = n.payload = Arena<TrieNode>::NONE;
+    n.label = label;
+    n.length = length;
+    return idx;
+}
+
+uint32_t TrieTable::find_child(uint32_t parent, char c, uint32_t& prev) const noexcept {
+    prev = Arena<TrieNode>::NONE;
+    for (uint32_t i = m_trie.at(parent).child; i != Arena<TrieNode>::NONE; i = m_trie.at(i).sibling) {
+        if (label(m_trie.at(i))[0] == c) return i;
+        prev = i;
+    }
+    return Arena<TrieNode>::NONE;
+}
+
+Node& TrieTable::get(const std::string& key, uint64_t, bool& inserted) {
+    std::string_view k = strip(key);
+    uint32_t cur = m_root;
+    size_t pos = 0;
+
+    while (pos < k.size()) {
+        uint32_t prev;
+        uint32_t c = find_child(cur, k[pos], prev);
+        if (c == Arena<TrieNode>::NONE) {
+            /* Rest of the key becomes a new leaf */
+            uint32_t leaf = add_node(add_label(k.substr(pos)), static_cast<uint8_t>(k.size() - pos));
+            m_trie.at(leaf).sibling = m_trie.at(cur).child;
+            m_trie.at(cur).child = leaf;
+            cur = leaf;
+            break;
+        }
+
+        TrieNode& child = m_trie.at(c);
+        const char* l = label(child);
+        size_t m = 1;
+        while (m < child.length && pos + m < k.size() && l[m] == k[pos + m]) m++;
+
+        if (m < child.length) {
+            /* Split edge, common part of the label goes to new node above the child */
+            uint32_t mid = add_node(child.label, static_cast<uint8_t>(m));
+            TrieNode& c_ref = m_trie.at(c);
+            TrieNode& mid_ref = m_trie.at(mid);
+            mid_ref.child = c;
+            mid_ref.sibling = c_ref.sibling;
+            c_ref.sibling = Arena<TrieNode>::NONE;
+            c_ref.label += static_cast<uint32_t>(m);
+            c_ref.length -= static_cast<uint8_t>(m);
+            if (prev == Arena<TrieNode>::NONE) {
+                m_trie.at(cur).child = mid;
+            } else {
+                m_trie.at(prev).sibling = mid;
+            }
+            c = mid;
+        }
+        cur = c;
+        pos += m;
+    }
+
+    TrieNode& n = m_trie.at(cur);
+    inserted = n.payload == Arena<Node>::NONE;
+    if (inserted) n.payload = m_payloads.allocate(current_numa_node());
+    return m_payloads.at(n.payload);
+}
+
+const Node* TrieTable::find(const std::string& key) const noexcept {
+    std::string_view k = strip(key);
+    uint32_t cur = m_root;
+    size_t pos = 0;
+
+    while (pos < k.size()) {
+        uint32_t prev;
+        uint32_t c = find_child(cur, k[pos], prev);
+        if (c == Arena<TrieNode>::NONE) return nullptr;
+        const TrieNode& child = m_trie.at(c);
+        if (pos + child.length > k.size() || std::memcmp(label(child), k.data() + pos, child.length) != 0) {
+            return nullptr;
+        }
+        cur = c;
+        pos += child.length;
+    }
+    uint32_t payload = m_trie.at(cur).payload;
+    return payload == Arena<Node>::NONE ? nullptr : &m_payloads.at(payload);
+}
+
+void TrieTable::visit(uint32_t idx, std::string& prefix,
+                      const std::function<void(const std::string&, Node&)>& f) const {
+    const TrieNode& n = m_trie.at(idx);
+    size_t length = prefix.size();
+    if (n.length > 0) prefix.append(label(n), n.length);
+    if (n.payload != Arena<Node>::NONE) f(prefix, m_payloads.at(n.payload));
+    for (uint32_t i = n.child; i != Arena<TrieNode>::NONE; i = m_trie.at(i).sibling) {
+        visit(i, prefix, f);
+    }
+    prefix.resize(length);
+}
+
+void TrieTable::for_each(const std::function<void(const std::string&, Node&)>& f) const {
+    std::string prefix;
+    visit(m_root, prefix, f);
+}
+
+void TrieTable::reserve(size_t n_nodes) {
+    m_payloads.reserve(n_nodes);
+    m_trie.reserve(2 * n_nodes);
+}
+
+size_t TrieTable::bytes_used() const noexcept {
+    return m_trie.bytes_mapped() + m_payloads.bytes_mapped() + (m_labels.size() << LABEL_CHUNK_BITS);
+}
+
+size_t TrieTable::bytes_per_node() const noexcept {
+    if (size() == 0) return 0;
+    return (m_trie.size() * sizeof(TrieNode) + size() * sizeof(Node) + m_label_bytes) / size();
+}
+
+void TrieTable::save_node(BufferedWriter& f, uint32_t idx) const {
+    const TrieNode& n = m_trie.at(idx);
+    uint8_t n_children = 0;
+    for (uint32_t i = n.child; i != Arena<TrieNode>::NONE; i = m_trie.at(i).sibling) n_children++;
+    uint8_t has_payload = n.payload != Arena<Node>::NONE;
+
+    f.write(&n.length, sizeof(uint8_t));
+    if (n.length > 0) f.write(label(n), n.length);
+    f.write(&has_payload, sizeof(uint8_t));
+    f.write(&n_children, sizeof(uint8_t));
+    if (has_payload) f.write(&m_payloads.at(n.payload), sizeof(Node));
+
+    for (uint32_t i = n.child; i != Arena<TrieNode>::NONE; i = m_trie.at(i).sibling) save_node(f, i);
+}
+
+bool TrieTable::save(const std::string& path, const std::vector<std::pair<std::string, Node>>& outside) const {
+    std::string tmp = path + ".tmp";
+    BufferedWriter f(tmp);
+    if (!f.is_open()) return false;
+    uint64_t n_nodes = size() + outside.size();
+    f.write(TRIE_MAGIC, sizeof(TRIE_MAGIC));
+    f.write(&n_nodes, sizeof(uint64_t));
+    save_node(f, m_root);
+
+    uint64_t n_outside = outside.size();
+    f.write(&n_outside, sizeof(uint64_t));
+    for (const auto& [key, node] : outside) {
+        std::string k = key;
+        k.resize(KEY_LENGTH, ' ');
+        f.write(k.data(), KEY_LENGTH);
+        f.write(&node, sizeof(Node));
+    }
+    return f.close() && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+uint32_t TrieTable::load_node(FILE* f) {
+    uint8_t length, has_payload, n_children;
+    char l[256];
+    if (fread(&length, sizeof(uint8_t), 1, f) != 1 || fread(l, sizeof(char), length, f) != length ||
+        fread(&has_payload, sizeof(uint8_t), 1, f) != 1 || fread(&n_children, sizeof(uint8_t), 1, f) != 1) {
+        return Arena<TrieNode>::NONE;
+    }
+
+    uint32_t idx = add_node(add_label(std::string_view(l, length)), length);
+    if (has_payload) {
+        uint32_t payload = m_payloads.allocate(current_numa_node());
+        if (fread(&m_payloads.at(payload), sizeof(Node), 1, f) != 1) return Arena<TrieNode>::NONE;
+        m_trie.at(idx).payload = payload;
+    }
+
+    /* Children are saved in sibling order, keep it */
+    uint32_t last = Arena<TrieNode>::NONE;
+    for (int i = 0; i < n_children; i++) {
+        uint32_t child = load_node(f);
+        if (child == Arena<TrieNode>::NONE) return Arena<TrieNode>::NONE;
+        if (last == Arena<TrieNode>::NONE) {
+            m_trie.at(idx).child = child;
+        } else {
+            m_trie.at(last).sibling = child;
+        }
+        last = child;
+    }
+    return idx;
+}
+
+bool TrieTable::load(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr) return false;
+    char magic[sizeof(TRIE_MAGIC)];
+    uint64_t n_nodes;
+    if (fread(magic, sizeof(char), sizeof(magic), f) != sizeof(magic) ||
+        std::memcmp(magic, TRIE_MAGIC, sizeof(magic)) != 0 || fread(&n_nodes, sizeof(uint64_t), 1, f) != 1) {
+        fclose(f);
+        return false;
+    }
+    reserve(n_nodes);
+    /* Saved root replaces the empty one */
+    uint32_t root = load_node(f);
+    if (root != Arena<TrieNode>::NONE) m_root = root;
+
+    uint64_t n_outside = 0;
+    bool ok = root != Arena<TrieNode>::NONE && fread(&n_outside, sizeof(uint64_t), 1, f) == 1;
+    char key[KEY_LENGTH];
+    for (uint64_t i = 0; ok && i < n_outside; i++) {
+        Node node;
+        ok = fread(key, sizeof(char), KEY_LENGTH, f) == KEY_LENGTH && fread(&node, sizeof(Node), 1, f) == 1;
+        bool inserted;
+        if (ok) get(std::string(key, KEY_LENGTH), 0, inserted) = node;
+    }
+    fclose(f);
+    return ok;
+}
+
+size_t TrieTable::count_saved(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr) return 0;
+    char magic[sizeof(TRIE_MAGIC)];
+    uint64_t n_nodes = 0;
+    bool ok = fread(magic, sizeof(char), sizeof(magic), f) == sizeof(magic) &&
+              std::memcmp(magic, TRIE_MAGIC, sizeof(magic)) == 0 && fread(&n_nodes, sizeof(uint64_t), 1, f) == 1;
+    fclose(f);
+    return ok ? n_nodes : 0;
+}
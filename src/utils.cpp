@@ -15,14 +15,25 @@
  */
  
  #include "utils.h"
+#include "trie.h"
+#include "writer.h"
 
+#include <atomic>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <optional>
 #include <sstream>
+#include <thread>
 #include <iomanip>
 #include <map>
 #include <algorithm>
 
+#include "fcntl.h"
+#include "unistd.h"
 #include "sys/types.h"
+#include "sys/stat.h"
 #include "sys/sysinfo.h"
 #include "stdlib.h"
 #include "stdio.h"
@@ -59,28 +70,160 @@ std::string pad_string(const std::string& str, int length){
     return ss.str();
 }
 
-void saveModel(std::unordered_map<std::string, Node>& tree){
-    std::cout << "Saving model. ";
-    std::unordered_map<std::string, Node>::iterator iter;
-    FILE *f = fopen("tree", "wb");
-    FILE *f_text = fopen("tree.txt", "w");
-
-    // std::map<std::string, Node> ordered(tree.begin(), tree.end());
-
-    // for(auto iter = ordered.begin(); iter != ordered.end(); ++iter){
-    for(iter=tree.begin(); iter!=tree.end(); iter++){
-        if ((iter->second).get_visits() == 0) continue;
-        fwrite((iter->first).c_str(), sizeof(char), KEY_LENGTH, f);
-        fwrite(&(iter->second), sizeof(Node), 1, f);
-        
-        if ((iter->second).get_visits() < 100) continue;
-        std::string text = iter->first;
-        text.append(":  ").append(std::string(iter->second)).append("\n");
-        fwrite(text.c_str(), text.length(), 1, f_text);
+std::string pad_key(const std::string& key){
+    if (key.size() > KEY_LENGTH) {
+        /* May be called by training thread, so nothing is unwound */
+        std::cout << "Key '" << key << "' is longer than KEY_LENGTH " << KEY_LENGTH << ".\n";
+        std::cout.flush();
+        std::abort();
     }
-    fclose(f);
-    fclose(f_text);
-    std::cout << "Done!\n";
+    return pad_string(key, KEY_LENGTH);
+}
+
+bool saveModel(const NodeStore& tree, const HotTier& hot, const std::string& path, uint32_t since_epoch){
+    bool delta = since_epoch > 0;
+    std::cout << (delta ? "Saving changes of model. " : "Saving model. ");
+    /* Written aside and renamed, so the previous checkpoint survives if training is killed while saving.
+       Disk writes run on threads of the writers, while this one walks the tree. */
+    std::string tmp = path + ".tmp";
+    BufferedWriter f(tmp);
+    std::optional<BufferedWriter> f_text;
+    if (!delta) f_text.emplace("tree.txt");
+
+    size_t n_saved = 0;
+    auto write = [&](const std::string& key, const Node& node){
+        /* Nodes reached only by opponent hold average strategy, they are needed to resume training */
+        if (node.get_visits() == 0 && node.get_visits2() == 0) return;
+        if (delta && node.get_epoch() <= since_epoch) return;
+        std::string k = pad_string(key, KEY_LENGTH);
+        f.write(k.c_str(), KEY_LENGTH);
+        f.write(&node, sizeof(Node));
+        n_saved++;
+
+        if (!f_text || node.get_visits() < 100) return;
+        std::string text = k;
+        text.append(":  ").append(std::string(node)).append("\n");
+        f_text->write(text.c_str(), text.length());
+    };
+    hot.for_each(write);
+    tree.for_each(write);
+    bool ok = f.close();
+    if (f_text) f_text->close();
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cout << "Failed!\n";
+        return false;
+    }
+    std::cout << "Done, " << n_saved << " nodes.\n";
+    return true;
+}
+
+bool load_checkpoint(const std::string& path, NodeStore& tree, int n_threads, size_t& n_records){
+    const size_t record = KEY_LENGTH + sizeof(Node);
+    n_records = 0;
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cout << "Cannot open " << path << ".\n";
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    n_records = static_cast<size_t>(st.st_size) / record;
+    tree.reserve(tree.size() + n_records);
+
+    /* Threads take blocks of records, read and hash them in parallel. Only insertion into the table is
+       serialized, it is cheap as the table is pre-sized and does not grow. */
+    std::mutex mutex;
+    std::atomic<size_t> next(0);
+    /* Partial record at the end means the file was cut */
+    std::atomic<bool> failed(static_cast<size_t>(st.st_size) % record != 0);
+    auto load = [&](){
+        std::vector<char> buffer(LOAD_BLOCK * record);
+        std::vector<std::string> keys(LOAD_BLOCK);
+        std::vector<uint64_t> hashes(LOAD_BLOCK);
+        for (size_t first = next.fetch_add(LOAD_BLOCK); first < n_records; first = next.fetch_add(LOAD_BLOCK)) {
+            size_t n = std::min(static_cast<size_t>(LOAD_BLOCK), n_records - first);
+            size_t bytes = 0;
+            while (bytes < n * record) {
+                ssize_t r = pread(fd, buffer.data() + bytes, n * record - bytes, first * record + bytes);
+                if (r <= 0) break;
+                bytes += r;
+            }
+            if (bytes < n * record) {
+                failed = true;
+                return;
+            }
+            for (size_t i = 0; i < n; i++) {
+                keys[i].assign(&buffer[i * record], KEY_LENGTH);
+                hashes[i] = tree.hash_key(keys[i]);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < n; i++) {
+                if (i + LOAD_PREFETCH < n) tree.prefetch(hashes[i + LOAD_PREFETCH]);
+                Node saved;
+                std::memcpy(static_cast<void*>(&saved), &buffer[i * record + KEY_LENGTH], sizeof(Node));
+                bool inserted;
+                Node& node = tree.get(keys[i], hashes[i], inserted);
+                if (inserted || saved.get_epoch() >= node.get_epoch()) node = saved;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < n_threads; i++) threads.emplace_back(load);
+    load();
+    for (std::thread& t : threads) t.join();
+    close(fd);
+
+    if (failed) {
+        std::cout << "Checkpoint " << path << " could not be read completely.\n";
+    }
+    return !failed;
+}
+
+bool save_training_state(const std::string& path, const TrainingState& state){
+    std::string tmp = path + ".tmp";
+    std::ostringstream ss;
+    ss << "iterations " << state.iterations << "\n"
+       << "seed " << state.seed << "\n"
+       << "epoch " << state.epoch << "\n"
+       << "deltas " << state.n_deltas << "\n";
+    /* Synced on close like the checkpoint itself */
+    BufferedWriter f(tmp);
+    if (!f.is_open()) return false;
+    std::string s = ss.str();
+    f.write(s.data(), s.size());
+    return f.close() && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool load_training_state(const std::string& path, TrainingState& state){
+    std::ifstream f(path);
+    std::string name;
+    bool has_iterations = false, has_seed = false;
+    while (f >> name) {
+        if (name == "iterations") {
+            has_iterations = static_cast<bool>(f >> state.iterations);
+        } else if (name == "seed") {
+            has_seed = static_cast<bool>(f >> state.seed);
+        } else if (name == "epoch") {
+            f >> state.epoch;
+        } else if (name == "deltas") {
+            f >> state.n_deltas;
+        }
+    }
+    return has_iterations && has_seed;
+}
+
+size_t count_saved_nodes(const std::string& path){
+    size_t n_trie_nodes = TrieTable::count_saved(path);
+    if (n_trie_nodes > 0) return n_trie_nodes;
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        std::cout << "Cannot open " << path << ".\n";
+        return 0;
+    }
+    return static_cast<size_t>(st.st_size) / (KEY_LENGTH + sizeof(Node));
 }
 
 std::unordered_map<std::string, Node> loadModel(){
@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2024 Jiri Kubes
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "fcntl.h"
+#include "unistd.h"
+
+BufferedWriter::BufferedWriter(const std::string& path, size_t buffer_size)
+    : m_fd(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644))
+    , m_filling(buffer_size)
+    , m_writing(buffer_size)
+    , m_used(0)
+    , m_write_size(0)
+    , m_pending(false)
+    , m_done(false)
+    , m_failed(m_fd < 0) {
+    if (is_open()) m_thread = std::thread(&BufferedWriter::run, this);
+}
+
+BufferedWriter::~BufferedWriter() { close(); }
+
+void BufferedWriter::write(const void* data, size_t n) {
+    if (!is_open()) return;
+    const char* p = static_cast<const char*>(data);
+    while (n > 0) {
+        size_t chunk = std::min(n, m_filling.size() - m_used);
+        std::memcpy(m_filling.data() + m_used, p, chunk);
+        m_used += chunk;
+        p += chunk;
+        n -= chunk;
+        if (m_used == m_filling.size()) hand_off();
+    }
+}
+
+void BufferedWriter::hand_off() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [&]{ return !m_pending; });
+    std::swap(m_filling, m_writing);
+    m_write_size = m_used;
+    m_used = 0;
+    m_pending = true;
+    m_cv.notify_all();
+}
+
+void BufferedWriter::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [&]{ return m_pending || m_done; });
+        if (!m_pending) return;
+
+        /* Producer does not touch the buffer while it is pending */
+        lock.unlock();
+        size_t written = 0;
+        while (written < m_write_size) {
+            ssize_t r = ::write(m_fd, m_writing.data() + written, m_write_size - written);
+            if (r <= 0) break;
+            written += r;
+        }
+        lock.lock();
+        if (written < m_write_size) m_failed = true;
+        m_pending = false;
+        m_cv.notify_all();
+    }
+}
+
+bool BufferedWriter::close() {
+    if (!is_open()) return !m_failed;
+    if (m_used > 0) hand_off();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    /* Data has to be on disk before the file is renamed over previous one, or crash could leave neither */
+    if (fsync(m_fd) != 0) m_failed = true;
+    if (::close(m_fd) != 0) m_failed = true;
+    m_fd = -1;
+    return !m_failed;
+}